@@ -33,6 +33,7 @@ public class GVExt : ModuleRules
             new string[]
             {
                 "GFCore",
+                "RenderCore",
             }
         );
 
@@ -9,3 +9,30 @@ UViewModeAction::UViewModeAction(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
+
+
+void UViewModeAction::ExecutePhase(EViewModeActionPhase Phase, UViewMode* OwningViewMode)
+{
+	switch (Phase)
+	{
+	case EViewModeActionPhase::PreActivate:
+		PreActivateMode(OwningViewMode);
+		break;
+
+	case EViewModeActionPhase::PostActivate:
+		PostActivateMode(OwningViewMode);
+		break;
+
+	case EViewModeActionPhase::PreDeactivate:
+		PreDeactivateMode(OwningViewMode);
+		break;
+
+	case EViewModeActionPhase::PostDeactivate:
+		PostDeactivateMode(OwningViewMode);
+		break;
+
+	default:
+		checkf(false, TEXT("ExecutePhase: Invalid Phase [%d]\n"), (uint8)Phase);
+		break;
+	}
+}
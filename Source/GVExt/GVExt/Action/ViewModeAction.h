@@ -7,8 +7,29 @@
 class UViewMode;
 
 
+/**
+ * Phases of the ViewMode activation in which ViewModeAction is called
+ */
+enum class EViewModeActionPhase : uint8
+{
+	None			= 0,
+	PreActivate		= 1 << 0,
+	PostActivate	= 1 << 1,
+	PreDeactivate	= 1 << 2,
+	PostDeactivate	= 1 << 3,
+
+	All				= PreActivate | PostActivate | PreDeactivate | PostDeactivate
+};
+ENUM_CLASS_FLAGS(EViewModeActionPhase);
+
+
 /**
  * Base class for processing to be performed when ViewMode is applied
+ * 
+ * Note:
+ *	Calls are deferred to the end of the camera evaluation of the frame.
+ *	PreActivate and PostDeactivate, as well as PostActivate and PreDeactivate, are treated as the inverse of each other
+ *	and are cancelled out when both are queued in succession for the same ViewMode.
  */
 UCLASS(Abstract, DefaultToInstanced, EditInlineNew, NotBlueprintable)
 class GVEXT_API UViewModeAction : public UObject
@@ -20,6 +41,28 @@ class GVEXT_API UViewModeAction : public UObject
 public:
 	UViewModeAction(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+protected:
+	//
+	// Phases implemented by this action. Phases not included are never queued.
+	// 
+	// Tips:
+	//	Subclasses should set this in the constructor to the phases they override.
+	//
+	EViewModeActionPhase HandledPhases{ EViewModeActionPhase::All };
+
+public:
+	bool HandlesPhase(EViewModeActionPhase Phase) const { return EnumHasAnyFlags(HandledPhases, Phase); }
+
+	/**
+	 * Call the function corresponding to the specified phase
+	 */
+	void ExecutePhase(EViewModeActionPhase Phase, UViewMode* OwningViewMode);
+
+	/**
+	 * Add the assets this action needs to the list loaded before the ViewMode starts blending in
+	 */
+	virtual void GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const {}
+
 protected:
 	/**
 	 * Called when Blend starts before ViewMode becomes Active.
@@ -0,0 +1,74 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeActionQueue.h"
+
+#include "Mode/ViewMode.h"
+
+
+void FViewModeActionQueue::Enqueue(UViewModeAction* Action, UViewMode* ViewMode, EViewModeActionPhase Phase)
+{
+	if (!Action || !Action->HandlesPhase(Phase))
+	{
+		return;
+	}
+
+	// Find the last command for the same action and ViewMode and cancel it if it is the opposing phase
+
+	for (auto Index{ Commands.Num() - 1 }; Index >= 0; --Index)
+	{
+		const auto& Command{ Commands[Index] };
+
+		if ((Command.Action == Action) && (Command.ViewMode == ViewMode))
+		{
+			if (Command.Phase == GetOpposingPhase(Phase))
+			{
+				Commands.RemoveAt(Index);
+				return;
+			}
+
+			break;
+		}
+	}
+
+	Commands.Emplace(Action, ViewMode, Phase);
+}
+
+void FViewModeActionQueue::Flush()
+{
+	// Move out before execution so that commands queued by the actions are executed in the next flush
+
+	auto PendingCommands{ MoveTemp(Commands) };
+	Commands.Reset();
+
+	for (const auto& Command : PendingCommands)
+	{
+		auto* Action{ Command.Action.Get() };
+		auto* ViewMode{ Command.ViewMode.Get() };
+
+		if (Action && ViewMode)
+		{
+			Action->ExecutePhase(Command.Phase, ViewMode);
+		}
+	}
+}
+
+EViewModeActionPhase FViewModeActionQueue::GetOpposingPhase(EViewModeActionPhase Phase)
+{
+	switch (Phase)
+	{
+	case EViewModeActionPhase::PreActivate:
+		return EViewModeActionPhase::PostDeactivate;
+
+	case EViewModeActionPhase::PostActivate:
+		return EViewModeActionPhase::PreDeactivate;
+
+	case EViewModeActionPhase::PreDeactivate:
+		return EViewModeActionPhase::PostActivate;
+
+	case EViewModeActionPhase::PostDeactivate:
+		return EViewModeActionPhase::PreActivate;
+
+	default:
+		return EViewModeActionPhase::None;
+	}
+}
@@ -0,0 +1,62 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Action/ViewModeAction.h"
+
+class UViewMode;
+
+
+/**
+ * Deferred call of a ViewModeAction
+ */
+struct FViewModeActionCommand
+{
+public:
+	FViewModeActionCommand() {}
+
+	FViewModeActionCommand(UViewModeAction* InAction, UViewMode* InViewMode, EViewModeActionPhase InPhase)
+		: Action(InAction), ViewMode(InViewMode), Phase(InPhase)
+	{}
+
+public:
+	TWeakObjectPtr<UViewModeAction> Action;
+	TWeakObjectPtr<UViewMode> ViewMode;
+	EViewModeActionPhase Phase{ EViewModeActionPhase::None };
+
+};
+
+
+/**
+ * Per-frame queue of ViewModeAction calls owned by ViewModeStack
+ * 
+ * Note:
+ *	When a command is queued right after its opposing phase for the same action and ViewMode,
+ *	both are removed so that rapid ViewMode changes do not produce redundant side effects.
+ */
+struct GVEXT_API FViewModeActionQueue
+{
+public:
+	FViewModeActionQueue() {}
+
+protected:
+	TArray<FViewModeActionCommand> Commands;
+
+public:
+	/**
+	 * Queue the call of the action or cancel the previous command if it is the opposing phase
+	 */
+	void Enqueue(UViewModeAction* Action, UViewMode* ViewMode, EViewModeActionPhase Phase);
+
+	/**
+	 * Execute all queued commands in order and empty the queue
+	 */
+	void Flush();
+
+	void Reset() { Commands.Reset(); }
+
+	int32 Num() const { return Commands.Num(); }
+
+	static EViewModeActionPhase GetOpposingPhase(EViewModeActionPhase Phase);
+
+};
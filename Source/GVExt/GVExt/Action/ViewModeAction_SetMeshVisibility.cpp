@@ -16,6 +16,7 @@
 UViewModeAction_SetMeshVisibility::UViewModeAction_SetMeshVisibility(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	HandledPhases = EViewModeActionPhase::PostActivate | EViewModeActionPhase::PreDeactivate;
 }
 
 
@@ -0,0 +1,208 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeCaptureComponent.h"
+
+#include "Capture/ViewModeCaptureSubsystem.h"
+#include "Mode/ViewMode.h"
+
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModeCaptureComponent)
+
+
+UViewModeCaptureComponent::UViewModeCaptureComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+
+void UViewModeCaptureComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!CaptureComponent)
+	{
+		SetCaptureComponent(GetOwner()->FindComponentByClass<USceneCaptureComponent2D>());
+	}
+
+	// Spread the captures of the components over the frames
+
+	TimeSinceLastCapture = (UpdateRate > 0.0f) ? FMath::FRand() / UpdateRate : 0.0f;
+}
+
+void UViewModeCaptureComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Only drops the reference, the Stack is kept while other captures still use it
+
+	ReleaseCaptureStack();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UViewModeCaptureComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	TimeSinceLastCapture += DeltaTime;
+
+	// Throttle to the update rate
+
+	if ((UpdateRate > 0.0f) && (TimeSinceLastCapture < (1.0f / UpdateRate)))
+	{
+		return;
+	}
+
+	if (ShouldUpdateCapture())
+	{
+		UpdateCapture();
+	}
+}
+
+
+bool UViewModeCaptureComponent::ShouldUpdateCapture() const
+{
+	if (!CaptureComponent || !ViewTarget || !ViewModeClass)
+	{
+		return false;
+	}
+
+	const auto* Owner{ GetOwner() };
+
+	if (bSkipWhenOwnerNotRendered && !Owner->WasRecentlyRendered(0.2f))
+	{
+		return false;
+	}
+
+	// Skip while every local player is too far away
+
+	if (MaxUpdateDistance > 0.0f)
+	{
+		const auto OwnerLocation{ Owner->GetActorLocation() };
+		const auto MaxDistanceSqr{ FMath::Square(MaxUpdateDistance) };
+
+		for (auto It{ GetWorld()->GetPlayerControllerIterator() }; It; ++It)
+		{
+			const auto* PlayerController{ It->Get() };
+			if (PlayerController && PlayerController->IsLocalController())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+				if (FVector::DistSquared(ViewLocation, OwnerLocation) <= MaxDistanceSqr)
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+bool UViewModeCaptureComponent::EvaluateView(float DeltaTime, FViewModeInfo& OutViewModeInfo)
+{
+	if (!ViewTarget || !ViewModeClass)
+	{
+		return false;
+	}
+
+	AcquireCaptureStack();
+
+	auto* Subsystem{ GetWorld()->GetSubsystem<UViewModeCaptureSubsystem>() };
+
+	if (!CaptureModeStack || !Subsystem)
+	{
+		return false;
+	}
+
+	return Subsystem->EvaluateStack(UViewModeCaptureSubsystem::FKey(AcquiredViewTarget, AcquiredViewModeClass), DeltaTime, OutViewModeInfo);
+}
+
+void UViewModeCaptureComponent::AcquireCaptureStack()
+{
+	const auto NewViewTarget{ TObjectKey<AActor>(ViewTarget.Get()) };
+	const auto NewViewModeClass{ TObjectKey<UClass>(ViewModeClass.Get()) };
+
+	if (CaptureModeStack && (AcquiredViewTarget == NewViewTarget) && (AcquiredViewModeClass == NewViewModeClass))
+	{
+		return;
+	}
+
+	ReleaseCaptureStack();
+
+	if (auto* Subsystem{ GetWorld()->GetSubsystem<UViewModeCaptureSubsystem>() })
+	{
+		CaptureModeStack = Subsystem->AcquireStack(ViewTarget, ViewModeClass);
+
+		if (CaptureModeStack)
+		{
+			AcquiredViewTarget = NewViewTarget;
+			AcquiredViewModeClass = NewViewModeClass;
+		}
+	}
+}
+
+void UViewModeCaptureComponent::ReleaseCaptureStack()
+{
+	if (!CaptureModeStack)
+	{
+		return;
+	}
+
+	if (auto* Subsystem{ GetWorld()->GetSubsystem<UViewModeCaptureSubsystem>() })
+	{
+		Subsystem->ReleaseStack(UViewModeCaptureSubsystem::FKey(AcquiredViewTarget, AcquiredViewModeClass));
+	}
+
+	CaptureModeStack = nullptr;
+	AcquiredViewTarget = TObjectKey<AActor>();
+	AcquiredViewModeClass = TObjectKey<UClass>();
+}
+
+void UViewModeCaptureComponent::UpdateCapture()
+{
+	FViewModeInfo ViewModeInfo;
+
+	if (CaptureComponent && EvaluateView(TimeSinceLastCapture, ViewModeInfo))
+	{
+		CaptureComponent->SetWorldLocationAndRotation(ViewModeInfo.Location, ViewModeInfo.Rotation);
+		CaptureComponent->FOVAngle = ViewModeInfo.FieldOfView;
+		CaptureComponent->CaptureScene();
+	}
+
+	TimeSinceLastCapture = 0.0f;
+}
+
+
+void UViewModeCaptureComponent::SetViewTarget(AActor* InViewTarget)
+{
+	// The Stack of the new target is acquired on the next evaluation
+
+	ViewTarget = InViewTarget;
+}
+
+void UViewModeCaptureComponent::SetViewMode(TSubclassOf<UViewMode> InViewModeClass)
+{
+	ViewModeClass = InViewModeClass;
+}
+
+void UViewModeCaptureComponent::SetCaptureComponent(USceneCaptureComponent2D* InCaptureComponent)
+{
+	CaptureComponent = InCaptureComponent;
+
+	// The capture is only updated by this component
+
+	if (CaptureComponent)
+	{
+		CaptureComponent->bCaptureEveryFrame = false;
+		CaptureComponent->bCaptureOnMovement = false;
+	}
+}
@@ -0,0 +1,122 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+
+#include "Mode/ViewModeTypes.h"
+
+#include "UObject/ObjectKey.h"
+
+#include "ViewModeCaptureComponent.generated.h"
+
+class UViewModeStack;
+class UViewMode;
+class USceneCaptureComponent2D;
+
+
+/**
+ * Component that drives a SceneCaptureComponent2D from a ViewModeStack (e.g. security monitors, mirrors, picture-in-picture)
+ * 
+ * Note:
+ *	Unlike ViewerComponent, it does not need to be owned by a Pawn nor a PlayerController.
+ *	The capture is updated at a reduced rate and skipped when it is too far from every local player or not rendered.
+ *	Captures viewing the same target with the same ViewMode borrow a single ViewModeStack from UViewModeCaptureSubsystem
+ *	and share its evaluation in the same frame.
+ */
+UCLASS(meta = (BlueprintSpawnableComponent))
+class GVEXT_API UViewModeCaptureComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UViewModeCaptureComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	//
+	// Stack borrowed from UViewModeCaptureSubsystem for the target and ViewMode it was acquired with
+	//
+	UPROPERTY(Transient)
+	TObjectPtr<UViewModeStack> CaptureModeStack;
+
+	TObjectKey<AActor> AcquiredViewTarget;
+	TObjectKey<UClass> AcquiredViewModeClass;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+
+protected:
+	//
+	// ViewMode used to evaluate the view of the capture
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+	TSubclassOf<UViewMode> ViewModeClass{ nullptr };
+
+	//
+	// Actor viewed by the capture
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Capture")
+	TObjectPtr<AActor> ViewTarget{ nullptr };
+
+	//
+	// Capture to be driven. The first SceneCaptureComponent2D of the owner is used if not set.
+	//
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Capture")
+	TObjectPtr<USceneCaptureComponent2D> CaptureComponent{ nullptr };
+
+	//
+	// Number of captures per second. 0 captures every frame.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (ClampMin = "0.0", Units = "Hz"))
+	float UpdateRate{ 10.0f };
+
+	//
+	// The capture is skipped while no local player is closer than this distance to the owner. 0 disables.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (ClampMin = "0.0", Units = "cm"))
+	float MaxUpdateDistance{ 5000.0f };
+
+	//
+	// If true, the capture is skipped while the owner (e.g. the monitor displaying it) has not been rendered recently
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
+	bool bSkipWhenOwnerNotRendered{ true };
+
+	float TimeSinceLastCapture{ 0.0f };
+
+protected:
+	/**
+	 * Returns whether the capture should be updated this frame
+	 */
+	bool ShouldUpdateCapture() const;
+
+	/**
+	 * Evaluate the ViewModeStack or reuse the evaluation of another capture in this frame
+	 */
+	bool EvaluateView(float DeltaTime, FViewModeInfo& OutViewModeInfo);
+
+	/**
+	 * Borrow the shared Stack for the current target and ViewMode, releasing the previous one if they changed
+	 */
+	void AcquireCaptureStack();
+	void ReleaseCaptureStack();
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Capture")
+	void SetViewTarget(AActor* InViewTarget);
+
+	UFUNCTION(BlueprintCallable, Category = "Capture")
+	void SetViewMode(TSubclassOf<UViewMode> InViewModeClass);
+
+	UFUNCTION(BlueprintCallable, Category = "Capture")
+	void SetCaptureComponent(USceneCaptureComponent2D* InCaptureComponent);
+
+	/**
+	 * Evaluate and capture immediately regardless of the update rate
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Capture")
+	void UpdateCapture();
+
+};
@@ -0,0 +1,119 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeCaptureSubsystem.h"
+
+#include "Mode/ViewModeStack.h"
+#include "Mode/ViewMode.h"
+#include "GVExtLogs.h"
+
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModeCaptureSubsystem)
+
+
+bool UViewModeCaptureSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+void UViewModeCaptureSubsystem::Deinitialize()
+{
+	for (const auto& Stack : Stacks)
+	{
+		if (Stack)
+		{
+			Stack->ReleaseViewModes();
+		}
+	}
+
+	SharedStacks.Reset();
+	Stacks.Reset();
+
+	Super::Deinitialize();
+}
+
+
+UViewModeStack* UViewModeCaptureSubsystem::AcquireStack(AActor* ViewTarget, TSubclassOf<UViewMode> ViewModeClass)
+{
+	if (!ViewTarget || !ViewModeClass)
+	{
+		return nullptr;
+	}
+
+	auto& Shared{ SharedStacks.FindOrAdd(FKey(ViewTarget, ViewModeClass.Get())) };
+
+	if (!Shared.Stack)
+	{
+		Shared.Stack = NewObject<UViewModeStack>(this);
+		Shared.Stack->SetViewTarget(ViewTarget);
+
+		// The player's camera owns the effects on the target and the world, the captures only need the view
+
+		Shared.Stack->SetSideEffectFree(true);
+
+		Stacks.Add(Shared.Stack);
+	}
+
+	++Shared.RefCount;
+
+	return Shared.Stack;
+}
+
+void UViewModeCaptureSubsystem::ReleaseStack(const FKey& Key)
+{
+	auto* Shared{ SharedStacks.Find(Key) };
+	const auto bAcquired{ Shared && (Shared->RefCount > 0) };
+
+	if (!GVEENSURE_MSG(bAcquired, TEXT("ReleaseStack: Stack viewing [%s] is not acquired"), *GetNameSafe(Key.Key.ResolveObjectPtr())))
+	{
+		return;
+	}
+
+	// The Stack is only released once no capture borrows it anymore
+
+	if (--Shared->RefCount > 0)
+	{
+		return;
+	}
+
+	if (Shared->Stack)
+	{
+		Shared->Stack->ReleaseViewModes();
+		Stacks.RemoveSingleSwap(Shared->Stack);
+	}
+
+	SharedStacks.Remove(Key);
+}
+
+bool UViewModeCaptureSubsystem::EvaluateStack(const FKey& Key, float DeltaTime, FViewModeInfo& OutViewModeInfo)
+{
+	auto* Shared{ SharedStacks.Find(Key) };
+	auto* ViewModeClass{ Key.Value.ResolveObjectPtr() };
+
+	if (!Shared || !Shared->Stack || !ViewModeClass)
+	{
+		return false;
+	}
+
+	// Reuse the evaluation of another capture in this frame
+
+	if (Shared->EvaluatedFrame == GFrameCounter)
+	{
+		OutViewModeInfo = Shared->View;
+		return true;
+	}
+
+	// The captures may have different update rates, so the Stack is advanced by the time since its own last evaluation
+
+	const auto Now{ GetWorld()->GetTimeSeconds() };
+	const auto StackDeltaTime{ (Shared->EvaluatedTime >= 0.0) ? static_cast<float>(Now - Shared->EvaluatedTime) : DeltaTime };
+
+	Shared->Stack->PushViewMode(ViewModeClass);
+	Shared->Stack->EvaluateStack(StackDeltaTime, OutViewModeInfo);
+
+	Shared->EvaluatedFrame = GFrameCounter;
+	Shared->EvaluatedTime = Now;
+	Shared->View = OutViewModeInfo;
+
+	return true;
+}
@@ -0,0 +1,89 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "Mode/ViewModeTypes.h"
+
+#include "Templates/SubclassOf.h"
+#include "UObject/ObjectKey.h"
+
+#include "ViewModeCaptureSubsystem.generated.h"
+
+class UViewModeStack;
+class UViewMode;
+
+
+/**
+ * ViewModeStack shared by the captures viewing the same target with the same ViewMode
+ */
+struct FViewModeCaptureSharedStack
+{
+public:
+	FViewModeCaptureSharedStack() {}
+
+public:
+	UViewModeStack* Stack{ nullptr };
+
+	//
+	// Number of captures borrowing the Stack
+	//
+	int32 RefCount{ 0 };
+
+	//
+	// Result of the last evaluation, reused by the other captures in the same frame
+	//
+	uint64 EvaluatedFrame{ MAX_uint64 };
+	double EvaluatedTime{ -1.0 };
+	FViewModeInfo View;
+
+};
+
+
+/**
+ * WorldSubsystem that owns one ViewModeStack per (target, ViewMode class) and lends it to UViewModeCaptureComponent
+ *
+ * Note:
+ *	The Stack is created by the first capture that acquires it and released when the last one releases it.
+ *	It is evaluated at most once per frame with the time elapsed since its previous evaluation.
+ */
+UCLASS()
+class GVEXT_API UViewModeCaptureSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UViewModeCaptureSubsystem() {}
+
+	using FKey = TPair<TObjectKey<AActor>, TObjectKey<UClass>>;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+protected:
+	TMap<FKey, FViewModeCaptureSharedStack> SharedStacks;
+
+	//
+	// Keeps the shared Stacks alive
+	//
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UViewModeStack>> Stacks;
+
+public:
+	/**
+	 * Returns the Stack viewing the target with the ViewMode and adds a reference to it
+	 */
+	UViewModeStack* AcquireStack(AActor* ViewTarget, TSubclassOf<UViewMode> ViewModeClass);
+
+	/**
+	 * Remove a reference added by AcquireStack, releasing the Stack when no capture uses it anymore
+	 */
+	void ReleaseStack(const FKey& Key);
+
+	/**
+	 * Evaluate the Stack or reuse its evaluation in this frame
+	 */
+	bool EvaluateStack(const FKey& Key, float DeltaTime, FViewModeInfo& OutViewModeInfo);
+
+};
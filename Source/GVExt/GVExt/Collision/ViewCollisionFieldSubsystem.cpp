@@ -0,0 +1,433 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewCollisionFieldSubsystem.h"
+
+#include "GVExtLogs.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/CameraBlockingVolume.h"
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewCollisionFieldSubsystem)
+
+
+static TAutoConsoleVariable<bool> CVarCollisionFieldEnable(
+	TEXT("gvext.CollisionField.Enable"),
+	false,
+	TEXT("If true, bake the static camera blocking geometry into a distance field when the world begins play."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCollisionFieldVoxelSize(
+	TEXT("gvext.CollisionField.VoxelSize"),
+	25.0f,
+	TEXT("Size of a voxel of the camera collision field. Applied to the worlds created after the change."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCollisionFieldBakeBricksPerFrame(
+	TEXT("gvext.CollisionField.BakeBricksPerFrame"),
+	8,
+	TEXT("Maximum number of bricks of the camera collision field baked per frame on the game thread."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCollisionFieldConservativeMargin(
+	TEXT("gvext.CollisionField.ConservativeMargin"),
+	1.0f,
+	TEXT("Scale of the voxel half diagonal subtracted from the sampled distance. 1 never overestimates the distance within a voxel but hits up to VoxelSize * sqrt(3) / 2 early, 0 hits at the surface but may step into the geometry."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCollisionFieldMaxTraceSteps(
+	TEXT("gvext.CollisionField.MaxTraceSteps"),
+	48,
+	TEXT("Maximum number of steps when sphere tracing the camera collision field."),
+	ECVF_Default);
+
+
+FViewCollisionFieldBrick::FViewCollisionFieldBrick()
+{
+	FMemory::Memset(Distances, MAX_uint8, sizeof(Distances));
+}
+
+
+bool UViewCollisionFieldSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return CVarCollisionFieldEnable.GetValueOnGameThread() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UViewCollisionFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+void UViewCollisionFieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	VoxelSize = FMath::Max(CVarCollisionFieldVoxelSize.GetValueOnGameThread(), 1.0f);
+	BrickSize = VoxelSize * FViewCollisionFieldBrick::Resolution;
+	TruncationDistance = BrickSize;
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ThisClass::HandleLevelAddedToWorld);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ThisClass::HandleLevelRemovedFromWorld);
+}
+
+void UViewCollisionFieldSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	BakeJobs.Reset();
+	LevelFields.Reset();
+
+	Super::Deinitialize();
+}
+
+void UViewCollisionFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Bake the levels that are already visible
+
+	for (auto* Level : InWorld.GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			BakeLevel(Level);
+		}
+	}
+}
+
+void UViewCollisionFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateBake();
+}
+
+TStatId UViewCollisionFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UViewCollisionFieldSubsystem, STATGROUP_Tickables);
+}
+
+
+void UViewCollisionFieldSubsystem::HandleLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld == GetWorld())
+	{
+		BakeLevel(InLevel);
+	}
+}
+
+void UViewCollisionFieldSubsystem::HandleLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	// A null level means that all levels are removed
+
+	if (InLevel)
+	{
+		LevelFields.Remove(InLevel);
+		BakeJobs.RemoveAll([InLevel](const TSharedPtr<FViewCollisionFieldBakeJob>& Job) { return Job->Level == InLevel; });
+	}
+	else
+	{
+		LevelFields.Reset();
+		BakeJobs.Reset();
+	}
+}
+
+void UViewCollisionFieldSubsystem::BakeLevel(ULevel* InLevel)
+{
+	if (!InLevel || LevelFields.Contains(InLevel))
+	{
+		return;
+	}
+
+	if (BakeJobs.ContainsByPredicate([InLevel](const TSharedPtr<FViewCollisionFieldBakeJob>& Job) { return Job->Level == InLevel; }))
+	{
+		return;
+	}
+
+	// Only the list of bricks is built here, the distances are computed a few bricks per frame
+
+	auto Job{ MakeShared<FViewCollisionFieldBakeJob>() };
+	Job->Level = InLevel;
+	Job->LevelName = GetNameSafe(InLevel->GetOuter());
+	Job->StartTime = FPlatformTime::Seconds();
+
+	for (const auto* Actor : InLevel->Actors)
+	{
+		if (!Actor)
+		{
+			continue;
+		}
+
+		const auto bIsCameraBlockingVolume{ Actor->IsA<ACameraBlockingVolume>() };
+
+		Actor->ForEachComponent<UPrimitiveComponent>(false,
+			[&](UPrimitiveComponent* Primitive)
+			{
+				if (!IsStaticCameraBlocker(Primitive))
+				{
+					return;
+				}
+
+				Job->Bounds += Primitive->Bounds.GetBox();
+
+				if (bIsCameraBlockingVolume)
+				{
+					Job->Field.CameraBlockingVolumes.Add(Primitive);
+					return;
+				}
+
+				const auto PrimitiveIndex{ Job->Primitives.Add(Primitive) };
+
+				const auto Bounds{ Primitive->Bounds.GetBox().ExpandBy(TruncationDistance) };
+				const auto MinCoord{ GetBrickCoord(Bounds.Min) };
+				const auto MaxCoord{ GetBrickCoord(Bounds.Max) };
+
+				for (auto BZ{ MinCoord.Z }; BZ <= MaxCoord.Z; ++BZ)
+				{
+					for (auto BY{ MinCoord.Y }; BY <= MaxCoord.Y; ++BY)
+					{
+						for (auto BX{ MinCoord.X }; BX <= MaxCoord.X; ++BX)
+						{
+							auto& Item{ Job->Items.AddDefaulted_GetRef() };
+							Item.PrimitiveIndex = PrimitiveIndex;
+							Item.BrickCoord = FIntVector(BX, BY, BZ);
+						}
+					}
+				}
+			});
+	}
+
+	BakeJobs.Add(Job);
+}
+
+void UViewCollisionFieldSubsystem::UpdateBake()
+{
+	// The primitives are queried on the game thread, where they cannot be unregistered or lose their physics bodies while being read
+
+	auto BudgetItems{ FMath::Max(CVarCollisionFieldBakeBricksPerFrame.GetValueOnGameThread(), 1) };
+
+	while (!BakeJobs.IsEmpty() && (BudgetItems > 0))
+	{
+		const auto Job{ BakeJobs[0] };
+
+		const auto LastItem{ FMath::Min(Job->NextItem + BudgetItems, Job->Items.Num()) };
+
+		BudgetItems -= (LastItem - Job->NextItem);
+
+		for (; Job->NextItem < LastItem; ++Job->NextItem)
+		{
+			const auto& Item{ Job->Items[Job->NextItem] };
+			const auto* Primitive{ Job->Primitives[Item.PrimitiveIndex].Get() };
+
+			if (!IsStaticCameraBlocker(Primitive))
+			{
+				continue;
+			}
+
+			// Bricks shared by several primitives keep the distance to the closest one
+
+			FViewCollisionFieldBrick BakedBrick;
+
+			if (BakeBrick(*Primitive, Item.BrickCoord, BakedBrick))
+			{
+				auto& Brick{ Job->Field.Bricks.FindOrAdd(Item.BrickCoord) };
+
+				for (auto VoxelIndex{ 0 }; VoxelIndex < FViewCollisionFieldBrick::NumVoxels; ++VoxelIndex)
+				{
+					Brick.Distances[VoxelIndex] = FMath::Min(Brick.Distances[VoxelIndex], BakedBrick.Distances[VoxelIndex]);
+				}
+			}
+		}
+
+		if (Job->NextItem >= Job->Items.Num())
+		{
+			FinishBakeJob(Job);
+		}
+	}
+}
+
+void UViewCollisionFieldSubsystem::FinishBakeJob(const TSharedPtr<FViewCollisionFieldBakeJob>& Job)
+{
+	UE_LOG(LogGVE, Log, TEXT("Baked camera collision field for [%s]: %d bricks (%.1f KB) in %.2f s"),
+		*Job->LevelName,
+		Job->Field.Bricks.Num(),
+		(Job->Field.Bricks.Num() * sizeof(FViewCollisionFieldBrick)) / 1024.0f,
+		FPlatformTime::Seconds() - Job->StartTime);
+
+	LevelFields.Add(Job->Level, MoveTemp(Job->Field));
+	BakeJobs.Remove(Job);
+}
+
+bool UViewCollisionFieldSubsystem::BakeBrick(const UPrimitiveComponent& Primitive, const FIntVector& BrickCoord, FViewCollisionFieldBrick& OutBrick) const
+{
+	const auto BrickHalfDiagonal{ BrickSize * UE_HALF_SQRT_3 };
+	const auto QuantizeScale{ MAX_uint8 / TruncationDistance };
+	const auto BrickOrigin{ GetBrickOrigin(BrickCoord) };
+
+	// Only the bricks in the narrow band around the surface are created.
+	// A negative distance means that the primitive has no collision that can be queried.
+
+	auto ClosestPoint{ FVector::ZeroVector };
+	const auto CenterDistance{ Primitive.GetDistanceToCollision(BrickOrigin + FVector(BrickSize * 0.5f), ClosestPoint) };
+
+	if ((CenterDistance < 0.0f) || (CenterDistance > (BrickHalfDiagonal + TruncationDistance)))
+	{
+		return false;
+	}
+
+	for (auto VZ{ 0 }; VZ < FViewCollisionFieldBrick::Resolution; ++VZ)
+	{
+		for (auto VY{ 0 }; VY < FViewCollisionFieldBrick::Resolution; ++VY)
+		{
+			for (auto VX{ 0 }; VX < FViewCollisionFieldBrick::Resolution; ++VX)
+			{
+				const auto VoxelCenter{ BrickOrigin + (FVector(VX, VY, VZ) + 0.5f) * VoxelSize };
+				const auto Distance{ FMath::Max(Primitive.GetDistanceToCollision(VoxelCenter, ClosestPoint), 0.0f) };
+				const auto Quantized{ static_cast<uint8>(FMath::Min(FMath::FloorToInt32(Distance * QuantizeScale), static_cast<int32>(MAX_uint8))) };
+
+				OutBrick.Distances[FViewCollisionFieldBrick::GetVoxelIndex(VX, VY, VZ)] = Quantized;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool UViewCollisionFieldSubsystem::IsStaticCameraBlocker(const UPrimitiveComponent* Primitive)
+{
+	return Primitive
+		&& (Primitive->Mobility == EComponentMobility::Static)
+		&& CollisionEnabledHasQuery(Primitive->GetCollisionEnabled())
+		&& (Primitive->GetCollisionResponseToChannel(ECC_Camera) == ECR_Block);
+}
+
+FIntVector UViewCollisionFieldSubsystem::GetBrickCoord(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / BrickSize),
+		FMath::FloorToInt32(Location.Y / BrickSize),
+		FMath::FloorToInt32(Location.Z / BrickSize));
+}
+
+FVector UViewCollisionFieldSubsystem::GetBrickOrigin(const FIntVector& BrickCoord) const
+{
+	return FVector(BrickCoord) * BrickSize;
+}
+
+
+float UViewCollisionFieldSubsystem::SampleDistance(const FVector& Location) const
+{
+	const auto BrickCoord{ GetBrickCoord(Location) };
+	const auto LocalLocation{ (Location - GetBrickOrigin(BrickCoord)) / VoxelSize };
+
+	const auto VX{ FMath::Clamp(FMath::FloorToInt32(LocalLocation.X), 0, FViewCollisionFieldBrick::Resolution - 1) };
+	const auto VY{ FMath::Clamp(FMath::FloorToInt32(LocalLocation.Y), 0, FViewCollisionFieldBrick::Resolution - 1) };
+	const auto VZ{ FMath::Clamp(FMath::FloorToInt32(LocalLocation.Z), 0, FViewCollisionFieldBrick::Resolution - 1) };
+	const auto VoxelIndex{ FViewCollisionFieldBrick::GetVoxelIndex(VX, VY, VZ) };
+
+	// Missing bricks are farther than the truncation distance from any geometry
+
+	auto MinQuantized{ static_cast<uint8>(MAX_uint8) };
+
+	for (const auto& KVP : LevelFields)
+	{
+		if (const auto* Brick{ KVP.Value.Bricks.Find(BrickCoord) })
+		{
+			MinQuantized = FMath::Min(MinQuantized, Brick->Distances[VoxelIndex]);
+		}
+	}
+
+	if (MinQuantized == MAX_uint8)
+	{
+		return TruncationDistance;
+	}
+
+	// Subtract the half diagonal of the voxel so that the distance never overestimates within the voxel.
+	// This makes the hits up to VoxelSize * sqrt(3) / 2 early (about 21 cm with the default 25 cm voxels).
+
+	const auto ConservativeMargin{ VoxelSize * UE_HALF_SQRT_3 * FMath::Max(CVarCollisionFieldConservativeMargin.GetValueOnAnyThread(), 0.0f) };
+
+	return (MinQuantized * (TruncationDistance / MAX_uint8)) - ConservativeMargin;
+}
+
+bool UViewCollisionFieldSubsystem::SphereTrace(const FVector& Start, const FVector& End, float Radius, float& OutHitTime) const
+{
+	const auto Delta{ End - Start };
+	const auto Length{ Delta.Size() };
+
+	if (Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const auto Direction{ Delta / Length };
+	const auto MinStep{ VoxelSize * 0.25f };
+	const auto MaxSteps{ CVarCollisionFieldMaxTraceSteps.GetValueOnGameThread() };
+
+	auto Travelled{ 0.0f };
+
+	for (auto Step{ 0 }; (Step < MaxSteps) && (Travelled <= Length); ++Step)
+	{
+		const auto Distance{ SampleDistance(Start + Direction * Travelled) - Radius };
+
+		if (Distance <= UE_KINDA_SMALL_NUMBER)
+		{
+			OutHitTime = Travelled / Length;
+			return true;
+		}
+
+		Travelled += FMath::Max(Distance, MinStep);
+	}
+
+	// Running out of steps before reaching the end is treated as a hit at the point reached,
+	// so that the camera never ends up behind geometry the trace did not get to
+
+	if (Travelled < Length)
+	{
+		OutHitTime = Travelled / Length;
+		return true;
+	}
+
+	return false;
+}
+
+bool UViewCollisionFieldSubsystem::IsSegmentBaked(const FVector& Start, const FVector& End, float Radius) const
+{
+	const auto StartToEnd{ End - Start };
+
+	for (const auto& Job : BakeJobs)
+	{
+		if (Job->Bounds.IsValid && FMath::LineBoxIntersection(Job->Bounds.ExpandBy(Radius), Start, End, StartToEnd))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UViewCollisionFieldSubsystem::GetCameraBlockingVolumes(const FVector& Start, const FVector& End, float Radius, TArray<UPrimitiveComponent*, TInlineAllocator<4>>& OutVolumes) const
+{
+	const auto StartToEnd{ End - Start };
+
+	for (const auto& KVP : LevelFields)
+	{
+		for (const auto& WeakVolume : KVP.Value.CameraBlockingVolumes)
+		{
+			auto* Volume{ WeakVolume.Get() };
+
+			if (Volume && FMath::LineBoxIntersection(Volume->Bounds.GetBox().ExpandBy(Radius), Start, End, StartToEnd))
+			{
+				OutVolumes.Add(Volume);
+			}
+		}
+	}
+}
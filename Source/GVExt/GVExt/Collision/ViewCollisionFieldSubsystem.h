@@ -0,0 +1,213 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "UObject/ObjectKey.h"
+
+#include "ViewCollisionFieldSubsystem.generated.h"
+
+class ULevel;
+class UPrimitiveComponent;
+
+
+/**
+ * Fixed size block of voxels of the camera collision field
+ *
+ * Note:
+ *	Distances are quantized to a byte in the range [0, TruncationDistance].
+ */
+struct FViewCollisionFieldBrick
+{
+public:
+	static constexpr int32 Resolution{ 8 };
+	static constexpr int32 NumVoxels{ Resolution * Resolution * Resolution };
+
+public:
+	FViewCollisionFieldBrick();
+
+public:
+	uint8 Distances[NumVoxels];
+
+public:
+	static int32 GetVoxelIndex(int32 X, int32 Y, int32 Z) { return X + (Y * Resolution) + (Z * Resolution * Resolution); }
+
+};
+
+
+/**
+ * Sparse set of bricks baked from the static geometry of a single level
+ */
+struct FViewCollisionFieldLevel
+{
+public:
+	FViewCollisionFieldLevel() {}
+
+public:
+	TMap<FIntVector, FViewCollisionFieldBrick> Bricks;
+
+	//
+	// CameraBlockingVolumes are not baked because their hits can be ignored depending on the view target
+	//
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> CameraBlockingVolumes;
+
+};
+
+
+/**
+ * Brick of a primitive to be baked
+ */
+struct FViewCollisionFieldBakeItem
+{
+public:
+	int32 PrimitiveIndex{ INDEX_NONE };
+	FIntVector BrickCoord{ FIntVector::ZeroValue };
+
+};
+
+
+/**
+ * Bake of a level in progress
+ *
+ * Note:
+ *	The bricks are accumulated in Field and only published to the subsystem when all items are baked.
+ */
+struct FViewCollisionFieldBakeJob
+{
+public:
+	FViewCollisionFieldBakeJob() {}
+
+public:
+	TObjectKey<ULevel> Level;
+	FString LevelName;
+
+	FViewCollisionFieldLevel Field;
+
+	TArray<TWeakObjectPtr<const UPrimitiveComponent>> Primitives;
+	TArray<FViewCollisionFieldBakeItem> Items;
+	int32 NextItem{ 0 };
+
+	//
+	// Bounds of the static camera blockers of the level, which are not covered by the field until the job is finished
+	//
+	FBox Bounds{ ForceInit };
+
+	double StartTime{ 0.0 };
+
+};
+
+
+/**
+ * WorldSubsystem that bakes the static camera blocking geometry into a sparse brick based distance field on the CPU
+ * and answers camera collision queries by sphere tracing it, without any physics scene query.
+ *
+ * Note:
+ *	The field is only created when "gvext.CollisionField.Enable" is set.
+ *	Each level has its own set of bricks, which are baked when the level is added to the world and released when it is removed.
+ *	The bake runs on the game thread at most "gvext.CollisionField.BakeBricksPerFrame" bricks per frame,
+ *	and a level is only used once all of its bricks are baked.
+ *	The distance is unsigned and clamped to 0 inside the geometry.
+ */
+UCLASS()
+class GVEXT_API UViewCollisionFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UViewCollisionFieldSubsystem() {}
+
+protected:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+
+protected:
+	TMap<TObjectKey<ULevel>, FViewCollisionFieldLevel> LevelFields;
+
+	float VoxelSize{ 25.0f };
+	float BrickSize{ 200.0f };
+	float TruncationDistance{ 200.0f };
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	//
+	// Levels waiting to be baked, the first one is being baked
+	//
+	TArray<TSharedPtr<FViewCollisionFieldBakeJob>> BakeJobs;
+
+protected:
+	void HandleLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld);
+	void HandleLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld);
+
+	/**
+	 * Collect the primitives of the level and queue the bake of their bricks
+	 */
+	void BakeLevel(ULevel* InLevel);
+
+	/**
+	 * Bake the next bricks of the queued levels within "gvext.CollisionField.BakeBricksPerFrame"
+	 */
+	void UpdateBake();
+
+	/**
+	 * Publish the field of the job once all of its items are baked
+	 */
+	void FinishBakeJob(const TSharedPtr<FViewCollisionFieldBakeJob>& Job);
+
+	/**
+	 * Bake a single brick of the primitive. Returns false if the brick is outside the narrow band of the surface.
+	 */
+	bool BakeBrick(const UPrimitiveComponent& Primitive, const FIntVector& BrickCoord, FViewCollisionFieldBrick& OutBrick) const;
+
+	static bool IsStaticCameraBlocker(const UPrimitiveComponent* Primitive);
+
+	FIntVector GetBrickCoord(const FVector& Location) const;
+	FVector GetBrickOrigin(const FIntVector& BrickCoord) const;
+
+public:
+	/**
+	 * Returns a conservative distance from the location to the nearest baked geometry
+	 *
+	 * Note:
+	 *	The half diagonal of a voxel scaled by "gvext.CollisionField.ConservativeMargin" is subtracted,
+	 *	which is about 21 cm with the default voxel size.
+	 */
+	float SampleDistance(const FVector& Location) const;
+
+	/**
+	 * Sphere trace the field from Start to End and returns whether the sphere hit the baked geometry
+	 *
+	 * Note:
+	 *	If "gvext.CollisionField.MaxTraceSteps" runs out before reaching End, it is treated as a hit at the point reached.
+	 */
+	bool SphereTrace(const FVector& Start, const FVector& End, float Radius, float& OutHitTime) const;
+
+	/**
+	 * Collect the CameraBlockingVolumes of the loaded levels that the segment may pass through
+	 */
+	void GetCameraBlockingVolumes(const FVector& Start, const FVector& End, float Radius, TArray<UPrimitiveComponent*, TInlineAllocator<4>>& OutVolumes) const;
+
+	/**
+	 * Returns whether any level has been baked into the field
+	 */
+	bool HasField() const { return !LevelFields.IsEmpty(); }
+
+	/**
+	 * Returns whether the static geometry that the segment may pass through is fully baked into the field
+	 *
+	 * Note:
+	 *	Returns false if the segment passes through the bounds of a level that is still queued or baking.
+	 *	The static geometry must then be tested with a physics scene query.
+	 */
+	bool IsSegmentBaked(const FVector& Start, const FVector& End, float Radius) const;
+
+};
@@ -0,0 +1,113 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewOccluderFadeSubsystem.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "UObject/UnrealType.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewOccluderFadeSubsystem)
+
+
+bool UViewOccluderFadeSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+void UViewOccluderFadeSubsystem::Deinitialize()
+{
+	for (const auto& KVP : Fades)
+	{
+		if (auto* Primitive{ KVP.Key.Key.Get() })
+		{
+			RestoreFade(Primitive, KVP.Key.Value, KVP.Value);
+		}
+	}
+
+	Fades.Reset();
+
+	Super::Deinitialize();
+}
+
+
+void UViewOccluderFadeSubsystem::AddFade(UPrimitiveComponent* Primitive, int32 DataIndex, float FadedDataValue)
+{
+	if (!Primitive || (DataIndex < 0))
+	{
+		return;
+	}
+
+	auto& Fade{ Fades.FindOrAdd(FKey(Primitive, DataIndex)) };
+
+	if (Fade.RefCount++ > 0)
+	{
+		return;
+	}
+
+	// Keep the value the materials of the primitive may already use at this index
+
+	const auto& CustomData{ Primitive->GetCustomPrimitiveData().Data };
+	Fade.OriginalNumData = CustomData.Num();
+	Fade.OriginalDataValue = CustomData.IsValidIndex(DataIndex) ? CustomData[DataIndex] : 0.0f;
+
+	// Render state is only touched here, i.e. when the faded set changes
+
+	Primitive->SetCustomPrimitiveDataFloat(DataIndex, FadedDataValue);
+}
+
+void UViewOccluderFadeSubsystem::RemoveFade(const TWeakObjectPtr<UPrimitiveComponent>& Primitive, int32 DataIndex)
+{
+	const FKey Key{ Primitive, DataIndex };
+
+	auto* Fade{ Fades.Find(Key) };
+	if (!Fade || (--Fade->RefCount > 0))
+	{
+		return;
+	}
+
+	if (auto* ResolvedPrimitive{ Primitive.Get() })
+	{
+		RestoreFade(ResolvedPrimitive, DataIndex, *Fade);
+	}
+
+	Fades.Remove(Key);
+}
+
+void UViewOccluderFadeSubsystem::RestoreFade(UPrimitiveComponent* Primitive, int32 DataIndex, const FViewOccluderFade& Fade) const
+{
+	if (DataIndex < Fade.OriginalNumData)
+	{
+		Primitive->SetCustomPrimitiveDataFloat(DataIndex, Fade.OriginalDataValue);
+		return;
+	}
+
+	// SetCustomPrimitiveDataFloat grew the data to reach the index and there is no public way to shrink it,
+	// so truncate the runtime data back to its original size through reflection.
+
+	static const auto* CustomDataProperty{ FindFProperty<FStructProperty>(UPrimitiveComponent::StaticClass(), TEXT("CustomPrimitiveDataInternal")) };
+
+	auto* CustomData{ CustomDataProperty ? CustomDataProperty->ContainerPtrToValuePtr<FCustomPrimitiveData>(Primitive) : nullptr };
+	if (!CustomData)
+	{
+		Primitive->SetCustomPrimitiveDataFloat(DataIndex, Fade.OriginalDataValue);
+		return;
+	}
+
+	// Other indices may have been set while faded, only drop the tail up to the faded index
+
+	if (CustomData->Data.Num() == (DataIndex + 1))
+	{
+		auto NewNum{ DataIndex };
+		while ((NewNum > Fade.OriginalNumData) && (CustomData->Data[NewNum - 1] == 0.0f))
+		{
+			--NewNum;
+		}
+
+		CustomData->Data.SetNum(NewNum);
+		Primitive->MarkRenderStateDirty();
+	}
+	else
+	{
+		Primitive->SetCustomPrimitiveDataFloat(DataIndex, Fade.OriginalDataValue);
+	}
+}
@@ -0,0 +1,78 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ViewOccluderFadeSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+
+/**
+ * Fade of a custom primitive data value shared by all the ViewModes fading the same primitive
+ */
+struct FViewOccluderFade
+{
+public:
+	FViewOccluderFade() {}
+
+public:
+	//
+	// Number of ViewModes fading the primitive
+	//
+	int32 RefCount{ 0 };
+
+	//
+	// Value of the custom primitive data before the first fade
+	//
+	float OriginalDataValue{ 0.0f };
+
+	//
+	// Number of custom primitive data values before the first fade
+	//
+	int32 OriginalNumData{ 0 };
+
+};
+
+
+/**
+ * WorldSubsystem that owns the custom primitive data of the occluders faded by the ViewModes
+ *
+ * Note:
+ *	Fades are reference counted per primitive and data index.
+ *	The first fade records the original value and the last one restores it, 
+ *	so ViewModes fading the same primitive at the same time never see the faded value as the original.
+ *	While the primitive is faded, the value of the first fade is kept.
+ */
+UCLASS()
+class GVEXT_API UViewOccluderFadeSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UViewOccluderFadeSubsystem() {}
+
+	using FKey = TPair<TWeakObjectPtr<UPrimitiveComponent>, int32>;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+protected:
+	TMap<FKey, FViewOccluderFade> Fades;
+
+public:
+	/**
+	 * Fade the primitive by setting the custom primitive data at DataIndex and adds a reference to the fade
+	 */
+	void AddFade(UPrimitiveComponent* Primitive, int32 DataIndex, float FadedDataValue);
+
+	/**
+	 * Remove a reference added by AddFade, restoring the original custom primitive data when no ViewMode fades the primitive anymore
+	 */
+	void RemoveFade(const TWeakObjectPtr<UPrimitiveComponent>& Primitive, int32 DataIndex);
+
+protected:
+	void RestoreFade(UPrimitiveComponent* Primitive, int32 DataIndex, const FViewOccluderFade& Fade) const;
+
+};
@@ -0,0 +1,23 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewTraceTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewTraceTypes)
+
+
+FViewTraceRequestHandle FViewTraceRequestHandle::GenerateNewHandle()
+{
+	static int32 GHandle{ 0 };
+
+	// Skip INDEX_NONE when the counter wraps around
+
+	if (++GHandle == INDEX_NONE)
+	{
+		++GHandle;
+	}
+
+	FViewTraceRequestHandle NewHandle;
+	NewHandle.Handle = GHandle;
+
+	return NewHandle;
+}
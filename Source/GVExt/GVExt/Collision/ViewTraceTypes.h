@@ -0,0 +1,133 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+
+#include "ViewTraceTypes.generated.h"
+
+class UPrimitiveComponent;
+
+
+/**
+ * Result of the camera penetration feelers published by ViewMode for other systems
+ */
+USTRUCT(BlueprintType)
+struct GVEXT_API FViewFeelerTraceResult
+{
+	GENERATED_BODY()
+public:
+	FViewFeelerTraceResult() {}
+
+public:
+	//
+	// Ratio of the distance from the safe location to the desired camera location that is not blocked (1.0 if not blocked)
+	//
+	UPROPERTY(BlueprintReadOnly)
+	float BlockedPct{ 1.0f };
+
+	//
+	// Primitive of the closest blocking hit of the feelers
+	//
+	UPROPERTY(BlueprintReadOnly)
+	TWeakObjectPtr<UPrimitiveComponent> HitComponent;
+
+	UPROPERTY(BlueprintReadOnly)
+	FVector SafeLocation{ FVector::ZeroVector };
+
+	UPROPERTY(BlueprintReadOnly)
+	FVector DesiredLocation{ FVector::ZeroVector };
+
+	//
+	// Number of feelers traced in this update and how many of them were blocked
+	//
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumSweeps{ 0 };
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumSweepHits{ 0 };
+
+	uint64 FrameNumber{ 0 };
+
+};
+
+
+/**
+ * Handle used to identify a view forward trace request
+ */
+USTRUCT(BlueprintType)
+struct GVEXT_API FViewTraceRequestHandle
+{
+	GENERATED_BODY()
+public:
+	FViewTraceRequestHandle() {}
+
+private:
+	UPROPERTY(Transient)
+	int32 Handle{ INDEX_NONE };
+
+public:
+	static FViewTraceRequestHandle GenerateNewHandle();
+
+	bool IsValid() const { return Handle != INDEX_NONE; }
+	void Invalidate() { Handle = INDEX_NONE; }
+
+	bool operator==(const FViewTraceRequestHandle& Other) const { return Handle == Other.Handle; }
+	bool operator!=(const FViewTraceRequestHandle& Other) const { return Handle != Other.Handle; }
+
+	friend uint32 GetTypeHash(const FViewTraceRequestHandle& InHandle) { return ::GetTypeHash(InHandle.Handle); }
+
+};
+
+
+/**
+ * Entry data for a requested view forward trace
+ */
+USTRUCT()
+struct FViewTraceRequest
+{
+	GENERATED_BODY()
+public:
+	FViewTraceRequest() {}
+
+public:
+	UPROPERTY(Transient)
+	FViewTraceRequestHandle Handle;
+
+	UPROPERTY(Transient)
+	TEnumAsByte<ECollisionChannel> TraceChannel{ ECC_Visibility };
+
+	UPROPERTY(Transient)
+	float Distance{ 0.0f };
+
+};
+
+
+/**
+ * View forward trace shared by all requests of the same channel
+ * 
+ * Note:
+ *	The trace is done once per frame with the longest distance requested for the channel.
+ */
+USTRUCT()
+struct FViewTraceChannelResult
+{
+	GENERATED_BODY()
+public:
+	FViewTraceChannelResult() {}
+
+public:
+	UPROPERTY(Transient)
+	TEnumAsByte<ECollisionChannel> TraceChannel{ ECC_Visibility };
+
+	UPROPERTY(Transient)
+	float MaxDistance{ 0.0f };
+
+	UPROPERTY(Transient)
+	FHitResult Hit;
+
+	UPROPERTY(Transient)
+	bool bBlockingHit{ false };
+
+};
@@ -2,11 +2,16 @@
 
 #include "ViewMode.h"
 
-#include "Action/ViewModeAction.h"
+#include "Mode/ViewModeStack.h"
+#include "Mode/ViewModeEvaluation.h"
 #include "ViewerComponent.h"
 
 #include "GameFramework/Character.h"
 #include "Components/CapsuleComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "UObject/UnrealType.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ViewMode)
 
@@ -40,58 +45,122 @@ void UViewMode::SetActivationState(EViewModeActivationState NewActivationState)
 	}
 	else if (ActivationState == EViewModeActivationState::Deactevated)
 	{
+		// The view is stale once the ViewMode leaves the Stack
+
+		bHasEvaluatedView = false;
+
 		PostDeactivateMode();
 	}
 }
 
-void UViewMode::PreActivateMode()
+void UViewMode::DispatchActions(EViewModeActionPhase Phase)
 {
+	auto* Stack{ OwningStack.Get() };
+
+	// Actions change the target for every viewer (e.g. mesh visibility)
+
+	if (Stack && Stack->IsSideEffectFree())
+	{
+		return;
+	}
+
 	for (const auto& Action : Actions)
 	{
-		if (Action)
+		if (Action && Action->HandlesPhase(Phase))
 		{
-			Action->PreActivateMode(this);
+			if (Stack)
+			{
+				Stack->EnqueueAction(Action, this, Phase);
+			}
+			else
+			{
+				Action->ExecutePhase(Phase, this);
+			}
 		}
 	}
 }
 
+void UViewMode::PreActivateMode()
+{
+	DispatchActions(EViewModeActionPhase::PreActivate);
+}
+
 void UViewMode::PostActivateMode()
 {
-	for (const auto& Action : Actions)
+	DispatchActions(EViewModeActionPhase::PostActivate);
+}
+
+void UViewMode::PreDeactivateMode()
+{
+	DispatchActions(EViewModeActionPhase::PreDeactivate);
+}
+
+void UViewMode::PostDeactivateMode()
+{
+	DispatchActions(EViewModeActionPhase::PostDeactivate);
+}
+
+
+void UViewMode::GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const auto& Asset : PreloadAssets)
 	{
-		if (Action)
+		if (!Asset.IsNull())
 		{
-			Action->PostActivateMode(this);
+			OutAssets.AddUnique(Asset.ToSoftObjectPath());
 		}
 	}
-}
 
-void UViewMode::PreDeactivateMode()
-{
 	for (const auto& Action : Actions)
 	{
 		if (Action)
 		{
-			Action->PreDeactivateMode(this);
+			Action->GatherPreloadAssets(OutAssets);
 		}
 	}
 }
 
-void UViewMode::PostDeactivateMode()
+bool UViewMode::StartPreload()
 {
-	for (const auto& Action : Actions)
+	// Already loading from a previous request
+
+	if (PreloadHandle.IsValid() && PreloadHandle->IsLoadingInProgress())
 	{
-		if (Action)
-		{
-			Action->PostDeactivateMode(this);
-		}
+		return true;
 	}
+
+	TArray<FSoftObjectPath> Assets;
+	GatherPreloadAssets(Assets);
+
+	Assets.RemoveAll([](const FSoftObjectPath& Path) { return Path.ResolveObject() != nullptr; });
+
+	if (Assets.IsEmpty())
+	{
+		return false;
+	}
+
+	PreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+
+	return PreloadHandle.IsValid() && !PreloadHandle->HasLoadCompleted();
+}
+
+bool UViewMode::IsPreloadComplete() const
+{
+	return !PreloadHandle.IsValid() || PreloadHandle->HasLoadCompleted() || PreloadHandle->WasCanceled();
 }
 
 
 FVector UViewMode::GetPivotLocation() const
 {
-	const auto* TargetPawn{ GetTargetPawnChecked() };
+	const auto* TargetPawn{ GetTargetPawn() };
+
+	// Targets that are not Pawns (e.g. watched by a capture) are viewed from their location
+
+	if (!TargetPawn)
+	{
+		const auto* Target{ GetTarget() };
+		return Target ? Target->GetActorLocation() : FVector::ZeroVector;
+	}
 
 	// Height adjustments for characters to account for crouching.
 
@@ -118,7 +187,13 @@ FVector UViewMode::GetPivotLocation() const
 
 FRotator UViewMode::GetPivotRotation() const
 {
-	const auto* TargetPawn{ GetTargetPawnChecked() };
+	const auto* TargetPawn{ GetTargetPawn() };
+
+	if (!TargetPawn)
+	{
+		const auto* Target{ GetTarget() };
+		return Target ? Target->GetActorRotation() : FRotator::ZeroRotator;
+	}
 
 	return TargetPawn->GetViewRotation();
 }
@@ -137,6 +212,18 @@ void UViewMode::UpdateView(float DeltaTime)
 	View.FieldOfView = FieldOfView;
 }
 
+void UViewMode::EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const
+{
+	auto PivotRotation{ Input.ControlRotation };
+
+	PivotRotation.Pitch = FMath::ClampAngle(PivotRotation.Pitch, ViewPitchMin, ViewPitchMax);
+
+	OutView.Location = Input.PivotLocation;
+	OutView.Rotation = PivotRotation;
+	OutView.ControlRotation = OutView.Rotation;
+	OutView.FieldOfView = FieldOfView;
+}
+
 void UViewMode::UpdateBlending(float DeltaTime)
 {
 	if (BlendTime > 0.0f)
@@ -178,9 +265,94 @@ void UViewMode::UpdateBlending(float DeltaTime)
 void UViewMode::UpdateViewMode(float DeltaTime)
 {
 	UpdateView(DeltaTime);
+
+	MarkViewUpdated();
+
 	UpdateBlending(DeltaTime);
 }
 
+void UViewMode::WarmUpViewMode(float DefaultDeltaTime)
+{
+	TGuardValue<bool> WarmingUpGuard(bWarmingUp, true);
+
+	// Each ViewMode is warmed at a different time, so use the time elapsed since its own last update
+
+	const auto* World{ GetWorld() };
+	const auto DeltaTime{ (World && (LastViewUpdateTime >= 0.0)) ? static_cast<float>(World->GetTimeSeconds() - LastViewUpdateTime) : DefaultDeltaTime };
+
+	PreWarmUpView();
+	UpdateView(DeltaTime);
+
+	MarkViewUpdated();
+}
+
+void UViewMode::MarkViewUpdated()
+{
+	const auto* World{ GetWorld() };
+
+	LastViewUpdateTime = World ? World->GetTimeSeconds() : -1.0;
+	bHasEvaluatedView = true;
+}
+
+bool UViewMode::CanApplySideEffects() const
+{
+	const auto* Stack{ OwningStack.Get() };
+
+	return !bWarmingUp && !(Stack && Stack->IsSideEffectFree());
+}
+
+/**
+ * Copy the values that can be edited in the editor or from Blueprint back from the archetype of the object
+ */
+static void ResetTunablesFromArchetype(UObject& Object)
+{
+	const auto* Archetype{ Object.GetArchetype() };
+
+	if (!Archetype || (Archetype->GetClass() != Object.GetClass()))
+	{
+		return;
+	}
+
+	for (TFieldIterator<FProperty> It(Object.GetClass()); It; ++It)
+	{
+		const auto* Property{ *It };
+
+		// Instanced references are skipped so that the object keeps its own subobjects, which are reset separately
+
+		if (!Property->HasAnyPropertyFlags(CPF_Edit | CPF_BlueprintVisible) || Property->HasAnyPropertyFlags(CPF_ContainsInstancedReference | CPF_InstancedReference | CPF_Transient))
+		{
+			continue;
+		}
+
+		Property->CopyCompleteValue_InContainer(&Object, Archetype);
+	}
+}
+
+void UViewMode::ResetViewMode()
+{
+	// Blueprints may have changed the tunables of this instance or of its Actions while it was used
+
+	ResetTunablesFromArchetype(*this);
+
+	for (const auto& Action : Actions)
+	{
+		if (Action)
+		{
+			ResetTunablesFromArchetype(*Action);
+		}
+	}
+
+	ActivationState = EViewModeActivationState::Deactevated;
+	OwningStack.Reset();
+	PreloadHandle.Reset();
+	BlendAlpha = 1.0f;
+	BlendWeight = 1.0f;
+	bResetInterpolation = false;
+	View = FViewModeInfo();
+	bHasEvaluatedView = false;
+	LastViewUpdateTime = -1.0;
+}
+
 void UViewMode::SetBlendWeight(float Weight)
 {
 	BlendWeight = FMath::Clamp(Weight, 0.0f, 1.0f);
@@ -221,7 +393,24 @@ UWorld* UViewMode::GetWorld() const
 
 AActor* UViewMode::GetTarget() const
 {
+	// The Stack may view another actor than the owner of the component (e.g. UViewModeCaptureComponent)
+
+	if (const auto* Stack{ OwningStack.Get() })
+	{
+		if (auto* StackTarget{ Stack->GetViewTarget() })
+		{
+			return StackTarget;
+		}
+	}
+
 	auto* Component{ GetViewerComponent() };
 
 	return Component ? Component->GetOwner() : nullptr;
 }
+
+EViewQualityLevel UViewMode::GetQualityLevel() const
+{
+	const auto* Component{ GetViewerComponent() };
+
+	return Component ? Component->GetViewQualityLevel() : EViewQualityLevel::Full;
+}
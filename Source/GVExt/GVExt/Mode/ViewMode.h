@@ -4,10 +4,14 @@
 
 #include "ViewModeTypes.h"
 
+#include "Action/ViewModeAction.h"
+
 #include "ViewMode.generated.h"
 
 class UViewerComponent;
-class UViewModeAction;
+class UViewModeStack;
+struct FStreamableHandle;
+struct FViewModeEvaluationInput;
 
 
 /**
@@ -17,6 +21,9 @@ UCLASS(Abstract, NotBlueprintable)
 class GVEXT_API UViewMode : public UObject
 {
 	GENERATED_BODY()
+
+	friend class UViewModeStack;
+
 public:
 	UViewMode(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
@@ -42,11 +49,62 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Instanced, Category = "Action")
 	TArray<TObjectPtr<UViewModeAction>> Actions;
 
+	//
+	// Assets loaded asynchronously before the ViewMode starts blending in.
+	// The previous ViewMode stays applied while they are loading.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Loading")
+	TArray<TSoftObjectPtr<UObject>> PreloadAssets;
+
+	//
+	// Maximum time to wait for the assets before blending in anyway
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Loading", meta = (ClampMin = "0.0", Units = "s"))
+	float PreloadTimeout{ 2.0f };
+
+
+protected:
+	//
+	// Keeps the preloaded assets resident while this instance is alive
+	//
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+
+protected:
+	/**
+	 * Collect the assets of this ViewMode and its Actions to be loaded before activation
+	 */
+	virtual void GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
+public:
+	/**
+	 * Start loading the assets that are not yet loaded. Returns false if there is nothing to wait for.
+	 */
+	bool StartPreload();
+
+	/**
+	 * Returns whether all assets requested by StartPreload have been loaded
+	 */
+	bool IsPreloadComplete() const;
+
+	float GetPreloadTimeout() const { return PreloadTimeout; }
+
 
 protected:
 	UPROPERTY(Transient)
 	EViewModeActivationState ActivationState{ EViewModeActivationState::Deactevated };
+
+	//
+	// Stack that queues the calls of Actions. Actions are called immediately if not set.
+	//
+	UPROPERTY(Transient)
+	TWeakObjectPtr<UViewModeStack> OwningStack;
 	
+protected:
+	/**
+	 * Queue the Actions that handle the phase to the OwningStack
+	 */
+	void DispatchActions(EViewModeActionPhase Phase);
+
 public:
 	/**
 	 * Change the ActivationState of the ViewMode
@@ -87,6 +145,11 @@ protected:
 
 	FViewModeInfo View;
 
+	//
+	// Whether View has been updated since the ViewMode was last deactivated
+	//
+	bool bHasEvaluatedView{ false };
+
 protected:
 	virtual FVector GetPivotLocation() const;
 	virtual FRotator GetPivotRotation() const;
@@ -94,14 +157,71 @@ protected:
 	virtual void UpdateView(float DeltaTime);
 	virtual void UpdateBlending(float DeltaTime);
 
+	/**
+	 * Called by WarmUpViewMode before UpdateView, while the ViewMode may never have been activated.
+	 * ViewModes that prepare their state on activation (e.g. a lookup table built in PreActivateMode) must prepare it here as well.
+	 */
+	virtual void PreWarmUpView() {}
+
+	bool bWarmingUp{ false };
+
+	//
+	// World time of the last update of the view, in or out of the Stack
+	//
+	double LastViewUpdateTime{ -1.0 };
+
+	void MarkViewUpdated();
+
 public:
 	void UpdateViewMode(float DeltaTime);
 
+	/**
+	 * Update the view while the ViewMode is not in the Stack so that its history (e.g. penetration) is ready when it is pushed.
+	 * The blending and the activation state are not changed.
+	 * 
+	 * Note:
+	 *	The view is updated with the time elapsed since its last update, or DefaultDeltaTime if it has never been updated.
+	 */
+	void WarmUpViewMode(float DefaultDeltaTime);
+
+	/**
+	 * Returns whether the view is being updated by WarmUpViewMode
+	 */
+	bool IsWarmingUp() const { return bWarmingUp; }
+
+	/**
+	 * Returns whether effects visible to the player (e.g. fading occluders or assist callbacks) may be applied.
+	 * False while warming up or when the owning Stack is side effect free (e.g. evaluated for a capture).
+	 */
+	bool CanApplySideEffects() const;
+
+	/**
+	 * Reset the runtime state so that the instance can be reused for another target.
+	 * Called when the instance is returned to the pool, without calling any activation callbacks.
+	 * 
+	 * Note:
+	 *	The properties editable in the editor or from Blueprint, of this instance and of its Actions, are reset from their archetype.
+	 *	Subclasses that add runtime state must override this and call Super.
+	 */
+	virtual void ResetViewMode();
+
 	void SetBlendWeight(float Weight);
 
+	/**
+	 * Evaluate the view from the input without using nor changing the runtime state.
+	 * Called on the class default object by ViewModeEvaluation.
+	 */
+	virtual void EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const;
+
+	/**
+	 * Keep the view evaluated by EvaluateView out of the world. Called on the class default object by ViewModeEvaluation.
+	 */
+	virtual void EvaluatePenetration(const FViewModeEvaluationInput& Input, const UWorld& World, FViewModeInfo& InOutView) const {}
+
 	float GetBlendTime() const { return BlendTime; }
 	float GetBlendWeight() const { return BlendWeight; }
 	const FViewModeInfo& GetViewModeInfo() const { return View; }
+	bool HasEvaluatedView() const { return bHasEvaluatedView; }
 
 
 public:
@@ -109,6 +229,11 @@ public:
 
 	virtual AActor* GetTarget() const;
 
+	/**
+	 * Returns the quality level requested by the ViewerComponent
+	 */
+	EViewQualityLevel GetQualityLevel() const;
+
 	template<typename T = UViewerComponent>
 	T* GetViewerComponent() const
 	{
@@ -0,0 +1,108 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeEvaluation.h"
+
+#include "Mode/ViewMode.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+
+namespace ViewModeEvaluation
+{
+	//
+	// Number of inputs below which the batch is evaluated on the calling thread
+	//
+	static constexpr int32 MinParallelBatchSize{ 64 };
+
+	static const UViewMode* GetViewModeDefault(TSubclassOf<UViewMode> ViewModeClass)
+	{
+		return ViewModeClass ? ViewModeClass->GetDefaultObject<UViewMode>() : nullptr;
+	}
+
+	static void EvaluateWithoutPenetration(const FViewModeEvaluationInput& Input, const UViewMode* ViewMode, const UViewMode* BlendFromViewMode, FViewModeInfo& OutView)
+	{
+		if (!ViewMode)
+		{
+			OutView = FViewModeInfo();
+			OutView.Location = Input.PivotLocation;
+			OutView.Rotation = Input.ControlRotation;
+			OutView.ControlRotation = Input.ControlRotation;
+			return;
+		}
+
+		ViewMode->EvaluateView(Input, OutView);
+
+		// Blend from the ViewMode being blended out
+
+		if (BlendFromViewMode && (Input.BlendWeight < 1.0f))
+		{
+			FViewModeInfo BlendFromView;
+			BlendFromViewMode->EvaluateView(Input, BlendFromView);
+
+			BlendFromView.Blend(OutView, Input.BlendWeight);
+			OutView = BlendFromView;
+		}
+	}
+
+	static void ApplyPenetration(const FViewModeEvaluationInput& Input, const UWorld& World, FViewModeInfo& InOutView)
+	{
+		// The ViewMode with the most weight decides how penetration is handled
+
+		const auto bUseBlendFrom{ Input.BlendFromViewModeClass && (Input.BlendWeight < 0.5f) };
+
+		if (const auto* ViewMode{ GetViewModeDefault(bUseBlendFrom ? Input.BlendFromViewModeClass : Input.ViewModeClass) })
+		{
+			ViewMode->EvaluatePenetration(Input, World, InOutView);
+		}
+	}
+
+
+	FViewModeInfo Evaluate(const FViewModeEvaluationInput& Input, const UWorld* World)
+	{
+		FViewModeInfo View;
+
+		EvaluateWithoutPenetration(Input, GetViewModeDefault(Input.ViewModeClass), GetViewModeDefault(Input.BlendFromViewModeClass), View);
+
+		if (World)
+		{
+			ApplyPenetration(Input, *World, View);
+		}
+
+		return View;
+	}
+
+	void EvaluateBatch(TConstArrayView<FViewModeEvaluationInput> Inputs, TArrayView<FViewModeInfo> OutViews, const UWorld* World)
+	{
+		check(Inputs.Num() == OutViews.Num());
+
+		// The class default objects may be created on first access, which is only allowed on the calling thread
+
+		TArray<const UViewMode*> ViewModes;
+		TArray<const UViewMode*> BlendFromViewModes;
+		ViewModes.SetNumUninitialized(Inputs.Num());
+		BlendFromViewModes.SetNumUninitialized(Inputs.Num());
+
+		for (auto Index{ 0 }; Index < Inputs.Num(); ++Index)
+		{
+			ViewModes[Index] = GetViewModeDefault(Inputs[Index].ViewModeClass);
+			BlendFromViewModes[Index] = GetViewModeDefault(Inputs[Index].BlendFromViewModeClass);
+		}
+
+		// Evaluating the views only reads the class default objects, so it can be spread over the workers
+
+		ParallelFor(Inputs.Num(), [&Inputs, &OutViews, &ViewModes, &BlendFromViewModes](int32 Index)
+			{
+				EvaluateWithoutPenetration(Inputs[Index], ViewModes[Index], BlendFromViewModes[Index], OutViews[Index]);
+			},
+			(Inputs.Num() < MinParallelBatchSize) ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+		if (World)
+		{
+			for (auto Index{ 0 }; Index < Inputs.Num(); ++Index)
+			{
+				ApplyPenetration(Inputs[Index], *World, OutViews[Index]);
+			}
+		}
+	}
+}
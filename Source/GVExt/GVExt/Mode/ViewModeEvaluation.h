@@ -0,0 +1,88 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewModeTypes.h"
+
+#include "Templates/SubclassOf.h"
+
+class UViewMode;
+class UWorld;
+class AActor;
+
+
+/**
+ * Compact input record to evaluate the view of a ViewMode without a ViewerComponent.
+ * 
+ * Tips:
+ *	The ViewMode can be resolved from a replicated view state with UViewerComponent::GetReplicatedViewMode().
+ */
+struct GVEXT_API FViewModeEvaluationInput
+{
+public:
+	FViewModeEvaluationInput() {}
+
+public:
+	//
+	// Location of the pivot of the target (e.g. the eye location of the Pawn without crouch adjustment)
+	//
+	FVector PivotLocation{ FVector::ZeroVector };
+
+	FRotator ControlRotation{ FRotator::ZeroRotator };
+
+	TSubclassOf<UViewMode> ViewModeClass{ nullptr };
+
+	//
+	// ViewMode being blended out and the weight of ViewModeClass over it.
+	// No blending is done if BlendFromViewModeClass is not set or BlendWeight is 1.
+	//
+	TSubclassOf<UViewMode> BlendFromViewModeClass{ nullptr };
+	float BlendWeight{ 1.0f };
+
+	//
+	// Vertical offset of the pivot for crouching (CrouchedEyeHeight - BaseEyeHeight while fully crouched)
+	//
+	float CrouchOffset{ 0.0f };
+
+	//
+	// Actor ignored by the penetration sweep, usually the Pawn being viewed
+	//
+	const AActor* IgnoredActor{ nullptr };
+
+	//
+	// Upright capsule of the actor whose penetration is prevented (usually the Pawn being viewed).
+	// The safe location of the sweep is picked on it the same way as the live update.
+	// If PenetrationTargetHalfHeight is 0, the crouch adjusted pivot is used as the safe location.
+	//
+	FVector PenetrationTargetLocation{ FVector::ZeroVector };
+	float PenetrationTargetRadius{ 0.0f };
+	float PenetrationTargetHalfHeight{ 0.0f };
+
+};
+
+
+/**
+ * Stateless evaluation of ViewModes (e.g. rebuild the camera a client was aiming from on the server for shot validation)
+ * 
+ * Note:
+ *	The evaluation only uses the class default objects of the ViewModes and never changes any state.
+ *	Interpolations over time (crouch, penetration blend in/out) are not applied, the input is expected to be the settled state.
+ *	ViewModes that depend on state not in the input (e.g. a spline) are evaluated from the pivot.
+ */
+namespace ViewModeEvaluation
+{
+	/**
+	 * Evaluate the view of a single input.
+	 * If World is set, a single penetration sweep is done against it.
+	 */
+	GVEXT_API FViewModeInfo Evaluate(const FViewModeEvaluationInput& Input, const UWorld* World = nullptr);
+
+	/**
+	 * Evaluate the views of all inputs. OutViews must have the same number of elements as Inputs.
+	 * 
+	 * Note:
+	 *	The class default objects are resolved on the calling thread, then the views are evaluated in parallel.
+	 *	The penetration sweeps are done on the calling thread.
+	 */
+	GVEXT_API void EvaluateBatch(TConstArrayView<FViewModeEvaluationInput> Inputs, TArrayView<FViewModeInfo> OutViews, const UWorld* World = nullptr);
+}
@@ -0,0 +1,95 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeOverrideTypes.h"
+
+#include "Mode/ViewMode.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModeOverrideTypes)
+
+
+FViewModeOverrideHandle FViewModeOverrideHandle::GenerateNewHandle()
+{
+	static int32 GHandle{ 0 };
+
+	// Skip INDEX_NONE when the counter wraps around
+
+	if (++GHandle == INDEX_NONE)
+	{
+		++GHandle;
+	}
+
+	FViewModeOverrideHandle NewHandle;
+	NewHandle.Handle = GHandle;
+
+	return NewHandle;
+}
+
+
+FViewModeOverrideHandle FViewModeOverrideContainer::AddOverride(TSubclassOf<UViewMode> InViewModeClass, FGameplayTag InOverrideTag, int32 InPriority)
+{
+	if (!InViewModeClass)
+	{
+		return FViewModeOverrideHandle();
+	}
+
+	FViewModeOverrideEntry NewEntry;
+	NewEntry.Handle = FViewModeOverrideHandle::GenerateNewHandle();
+	NewEntry.ViewModeClass = InViewModeClass;
+	NewEntry.OverrideTag = InOverrideTag;
+	NewEntry.Priority = InPriority;
+
+	// Insert in front of the first entry with the same or lower priority so that the newest request wins ties
+
+	auto InsertIndex{ 0 };
+	while ((InsertIndex < Entries.Num()) && (Entries[InsertIndex].Priority > InPriority))
+	{
+		++InsertIndex;
+	}
+
+	Entries.Insert(NewEntry, InsertIndex);
+
+	return NewEntry.Handle;
+}
+
+bool FViewModeOverrideContainer::RemoveOverride(const FViewModeOverrideHandle& InHandle)
+{
+	if (!InHandle.IsValid())
+	{
+		return false;
+	}
+
+	const auto Index{ Entries.IndexOfByPredicate([&InHandle](const FViewModeOverrideEntry& Entry) { return Entry.Handle == InHandle; }) };
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// RemoveAt keeps the order, so the sorting is preserved
+
+	Entries.RemoveAt(Index);
+
+	return true;
+}
+
+TSubclassOf<UViewMode> FViewModeOverrideContainer::FindViewModeClass(const FViewModeOverrideHandle& InHandle) const
+{
+	if (!InHandle.IsValid())
+	{
+		return nullptr;
+	}
+
+	const auto* Entry{ Entries.FindByPredicate([&InHandle](const FViewModeOverrideEntry& Entry) { return Entry.Handle == InHandle; }) };
+
+	return Entry ? Entry->ViewModeClass : nullptr;
+}
+
+int32 FViewModeOverrideContainer::RemoveOverridesByTag(const FGameplayTag& InOverrideTag)
+{
+	if (!InOverrideTag.IsValid())
+	{
+		return 0;
+	}
+
+	return Entries.RemoveAll([&InOverrideTag](const FViewModeOverrideEntry& Entry) { return Entry.OverrideTag.MatchesTag(InOverrideTag); });
+}
@@ -0,0 +1,116 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "Templates/SubclassOf.h"
+
+#include "ViewModeOverrideTypes.generated.h"
+
+class UViewMode;
+
+
+/**
+ * Handle used to identify a ViewMode override request
+ */
+USTRUCT(BlueprintType)
+struct GVEXT_API FViewModeOverrideHandle
+{
+	GENERATED_BODY()
+public:
+	FViewModeOverrideHandle() {}
+
+private:
+	UPROPERTY(Transient)
+	int32 Handle{ INDEX_NONE };
+
+public:
+	static FViewModeOverrideHandle GenerateNewHandle();
+
+	bool IsValid() const { return Handle != INDEX_NONE; }
+	void Invalidate() { Handle = INDEX_NONE; }
+
+	bool operator==(const FViewModeOverrideHandle& Other) const { return Handle == Other.Handle; }
+	bool operator!=(const FViewModeOverrideHandle& Other) const { return Handle != Other.Handle; }
+
+	friend uint32 GetTypeHash(const FViewModeOverrideHandle& InHandle) { return ::GetTypeHash(InHandle.Handle); }
+
+};
+
+
+/**
+ * Entry data for a requested ViewMode override
+ */
+USTRUCT()
+struct FViewModeOverrideEntry
+{
+	GENERATED_BODY()
+public:
+	FViewModeOverrideEntry() {}
+
+public:
+	UPROPERTY(Transient)
+	FViewModeOverrideHandle Handle;
+
+	UPROPERTY(Transient)
+	TSubclassOf<UViewMode> ViewModeClass{ nullptr };
+
+	UPROPERTY(Transient)
+	FGameplayTag OverrideTag;
+
+	UPROPERTY(Transient)
+	int32 Priority{ 0 };
+
+};
+
+
+/**
+ * Container that arbitrates ViewMode override requests by priority
+ *
+ * Note:
+ *	Entries are kept sorted in descending order of priority when they are added or removed,
+ *	so the winning override is always the first entry and can be referenced without any per-frame cost.
+ *	Among entries with the same priority, the most recently added one wins.
+ */
+USTRUCT()
+struct FViewModeOverrideContainer
+{
+	GENERATED_BODY()
+public:
+	FViewModeOverrideContainer() {}
+
+private:
+	UPROPERTY(Transient)
+	TArray<FViewModeOverrideEntry> Entries;
+
+public:
+	/**
+	 * Add a new override request and returns its handle
+	 */
+	FViewModeOverrideHandle AddOverride(TSubclassOf<UViewMode> InViewModeClass, FGameplayTag InOverrideTag, int32 InPriority);
+
+	/**
+	 * Remove the override request with the specified handle
+	 */
+	bool RemoveOverride(const FViewModeOverrideHandle& InHandle);
+
+	/**
+	 * Returns the ViewMode class requested with the specified handle, or nullptr if it is no longer requested
+	 */
+	TSubclassOf<UViewMode> FindViewModeClass(const FViewModeOverrideHandle& InHandle) const;
+
+	/**
+	 * Remove all override requests that match the specified tag and returns the number of removed requests
+	 */
+	int32 RemoveOverridesByTag(const FGameplayTag& InOverrideTag);
+
+	/**
+	 * Remove all override requests
+	 */
+	void Reset() { Entries.Reset(); }
+
+	TSubclassOf<UViewMode> GetWinningViewMode() const { return Entries.IsEmpty() ? nullptr : Entries[0].ViewModeClass; }
+	FGameplayTag GetWinningTag() const { return Entries.IsEmpty() ? FGameplayTag::EmptyTag : Entries[0].OverrideTag; }
+	int32 Num() const { return Entries.Num(); }
+
+};
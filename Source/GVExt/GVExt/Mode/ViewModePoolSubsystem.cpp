@@ -0,0 +1,76 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModePoolSubsystem.h"
+
+#include "Mode/ViewMode.h"
+
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModePoolSubsystem)
+
+
+static TAutoConsoleVariable<int32> CVarPoolMaxInstancesPerClass(
+	TEXT("gvext.Pool.MaxInstancesPerClass"),
+	16,
+	TEXT("Maximum number of ViewMode instances kept in the pool for each class. 0 disables pooling."),
+	ECVF_Default);
+
+static constexpr ERenameFlags ViewModePoolRenameFlags{ REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional };
+
+
+bool UViewModePoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+void UViewModePoolSubsystem::Deinitialize()
+{
+	Pool.Reset();
+
+	Super::Deinitialize();
+}
+
+
+UViewMode* UViewModePoolSubsystem::AcquireViewMode(TSubclassOf<UViewMode> ViewModeClass, UObject* Outer)
+{
+	check(ViewModeClass);
+	check(Outer);
+
+	// Reuse a pooled instance if available
+
+	if (auto* Entry{ Pool.Find(ViewModeClass) })
+	{
+		while (!Entry->Instances.IsEmpty())
+		{
+			if (auto* ViewMode{ Entry->Instances.Pop() })
+			{
+				ViewMode->Rename(nullptr, Outer, ViewModePoolRenameFlags);
+				return ViewMode;
+			}
+		}
+	}
+
+	return NewObject<UViewMode>(Outer, ViewModeClass, NAME_None, RF_NoFlags);
+}
+
+void UViewModePoolSubsystem::ReleaseViewMode(UViewMode* ViewMode)
+{
+	if (!ViewMode)
+	{
+		return;
+	}
+
+	auto& Entry{ Pool.FindOrAdd(ViewMode->GetClass()) };
+
+	// Let the instance be garbage collected if the pool of this class is full
+
+	if (Entry.Instances.Num() >= CVarPoolMaxInstancesPerClass.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	ViewMode->ResetViewMode();
+	ViewMode->Rename(nullptr, this, ViewModePoolRenameFlags);
+
+	Entry.Instances.Add(ViewMode);
+}
@@ -0,0 +1,64 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "Templates/SubclassOf.h"
+
+#include "ViewModePoolSubsystem.generated.h"
+
+class UViewMode;
+
+
+/**
+ * Pooled instances of a ViewMode class
+ */
+USTRUCT()
+struct FViewModePoolEntry
+{
+	GENERATED_BODY()
+public:
+	FViewModePoolEntry() {}
+
+public:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UViewMode>> Instances;
+
+};
+
+
+/**
+ * WorldSubsystem that recycles ViewMode instances (and their instanced Actions) across Pawn respawns
+ *
+ * Note:
+ *	Instances are reset with UViewMode::ResetViewMode (runtime state and tunables) when they are returned to the pool,
+ *	and moved under the new owner when they are acquired again.
+ */
+UCLASS()
+class GVEXT_API UViewModePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UViewModePoolSubsystem() {}
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+protected:
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<UViewMode>, FViewModePoolEntry> Pool;
+
+public:
+	/**
+	 * Returns a reset instance of the ViewMode class owned by the specified outer, creating it if the pool is empty
+	 */
+	UViewMode* AcquireViewMode(TSubclassOf<UViewMode> ViewModeClass, UObject* Outer);
+
+	/**
+	 * Reset the instance and return it to the pool
+	 */
+	void ReleaseViewMode(UViewMode* ViewMode);
+
+};
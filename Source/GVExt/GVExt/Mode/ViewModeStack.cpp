@@ -3,10 +3,98 @@
 #include "ViewModeStack.h"
 
 #include "Mode/ViewMode.h"
+#include "Mode/ViewModePoolSubsystem.h"
+#include "GVExtLogs.h"
+
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModeStack)
 
 
+static TAutoConsoleVariable<int32> CVarStackMaxEvaluatedDepth(
+	TEXT("gvext.Stack.MaxEvaluatedDepth"),
+	4,
+	TEXT("Maximum number of ViewModes evaluated in the Stack. Deeper layers are collapsed into a frozen pose. 0 disables the limit."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarStackCollapseWeight(
+	TEXT("gvext.Stack.CollapseWeight"),
+	0.01f,
+	TEXT("Layers whose remaining contribution to the blend is below this weight are collapsed into a frozen pose. 0 disables."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarStackWarmUpRate(
+	TEXT("gvext.Stack.WarmUpRate"),
+	10.0f,
+	TEXT("Number of warm ViewModes evaluated per second while they are not in the Stack. One ViewMode is evaluated at a time. 0 disables."),
+	ECVF_Default);
+
+
+#if !UE_BUILD_SHIPPING
+
+static TAutoConsoleVariable<bool> CVarStackValidate(
+	TEXT("gvext.Stack.Validate"),
+	false,
+	TEXT("If true, check the invariants of the ViewModeStack (weights, uniqueness and size) after every push and evaluation."),
+	ECVF_Cheat);
+
+/**
+ * Measure the cost of blending the specified number of layers.
+ * Usage: gvext.Stack.BenchmarkBlend [Iterations]
+ * Can be run headless with -ExecCmds="gvext.Stack.BenchmarkBlend".
+ */
+static FAutoConsoleCommand CmdStackBenchmarkBlend(
+	TEXT("gvext.Stack.BenchmarkBlend"),
+	TEXT("Measure the cost of FViewModeInfo::Blend for 1 to 16 layers. Usage: gvext.Stack.BenchmarkBlend [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda(
+		[](const TArray<FString>& Args)
+		{
+			const auto Iterations{ Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000 };
+
+			// Deterministic random layers so that results are comparable between runs
+
+			auto RandomStream{ FRandomStream(0x47564578) };
+
+			TArray<FViewModeInfo> Layers;
+			TArray<float> Weights;
+
+			for (auto Index{ 0 }; Index < 16; ++Index)
+			{
+				auto& Layer{ Layers.AddDefaulted_GetRef() };
+				Layer.Location = RandomStream.VRand() * 500.0f;
+				Layer.Rotation = FRotator(RandomStream.FRandRange(-89.0f, 89.0f), RandomStream.FRandRange(-180.0f, 180.0f), 0.0f);
+				Layer.ControlRotation = Layer.Rotation;
+				Layer.FieldOfView = RandomStream.FRandRange(60.0f, 110.0f);
+
+				Weights.Add(RandomStream.FRand());
+			}
+
+			for (auto NumLayers{ 1 }; NumLayers <= Layers.Num(); NumLayers *= 2)
+			{
+				auto Result{ FViewModeInfo() };
+
+				const auto StartCycles{ FPlatformTime::Cycles64() };
+
+				for (auto Iteration{ 0 }; Iteration < Iterations; ++Iteration)
+				{
+					Result = Layers[NumLayers - 1];
+
+					for (auto LayerIndex{ NumLayers - 2 }; LayerIndex >= 0; --LayerIndex)
+					{
+						Result.Blend(Layers[LayerIndex], Weights[LayerIndex]);
+					}
+				}
+
+				const auto ElapsedNs{ FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1.0e9 };
+
+				UE_LOG(LogGVE, Display, TEXT("BenchmarkBlend: %2d layers: %.2f ns/evaluation (FOV %.2f)"), NumLayers, ElapsedNs / Iterations, Result.FieldOfView);
+			}
+		}));
+
+#endif
+
+
 UViewModeStack::UViewModeStack(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -27,11 +115,16 @@ UViewMode* UViewModeStack::GetViewModeInstance(TSubclassOf<UViewMode> ViewModeCl
 		}
 	}
 
-	// Create an instance if not already created
+	// Create an instance if not already created, recycling one from the pool of the world if possible
+
+	auto* World{ GetWorld() };
+	auto* Pool{ World ? World->GetSubsystem<UViewModePoolSubsystem>() : nullptr };
 
-	auto* NewViewMode{ NewObject<UViewMode>(GetOuter(), ViewModeClass, NAME_None, RF_NoFlags) };
+	auto* NewViewMode{ Pool ? Pool->AcquireViewMode(ViewModeClass, GetOuter()) : NewObject<UViewMode>(GetOuter(), ViewModeClass, NAME_None, RF_NoFlags) };
 	check(NewViewMode);
 
+	NewViewMode->OwningStack = this;
+
 	// Add instances to an array for later reference
 
 	ViewModeInstances.Add(NewViewMode);
@@ -42,12 +135,17 @@ UViewMode* UViewModeStack::GetViewModeInstance(TSubclassOf<UViewMode> ViewModeCl
 
 void UViewModeStack::UpdateStack(float DeltaTime)
 {
+	// Bound the number of evaluated layers before updating
+
+	CollapseStack();
+
 	const auto StackSize{ ViewModeStack.Num() };
 
 	// If Stack is less than or equal to 0 (i.e., empty), skip
 
 	if (StackSize <= 0)
 	{
+		bHasFrozenBase = false;
 		return;
 	}
 
@@ -72,6 +170,10 @@ void UViewModeStack::UpdateStack(float DeltaTime)
 			RemoveIndex = (StackIndex + 1);
 			RemoveCount = (StackSize - RemoveIndex);
 
+			// Layers below a fully blended one, including the frozen pose, no longer contribute
+
+			bHasFrozenBase = false;
+
 			// Set ActivationState to Activated because the Blend of Index 0 has been completed, which means that it has become fully Active.
 
 			if (StackIndex == 0)
@@ -103,6 +205,100 @@ void UViewModeStack::UpdateStack(float DeltaTime)
 	}
 }
 
+void UViewModeStack::CollapseStack()
+{
+	const auto StackSize{ ViewModeStack.Num() };
+	const auto MaxDepth{ CVarStackMaxEvaluatedDepth.GetValueOnGameThread() };
+	const auto CollapseWeight{ CVarStackCollapseWeight.GetValueOnGameThread() };
+
+	// Find the first layer to collapse
+
+	auto CollapseIndex{ ((MaxDepth > 0) && (StackSize > MaxDepth)) ? MaxDepth : StackSize };
+
+	if (CollapseWeight > 0.0f)
+	{
+		auto RemainingWeight{ 1.0f };
+
+		for (auto StackIndex{ 0 }; StackIndex < CollapseIndex - 1; ++StackIndex)
+		{
+			RemainingWeight *= (1.0f - ViewModeStack[StackIndex]->GetBlendWeight());
+
+			if (RemainingWeight < CollapseWeight)
+			{
+				CollapseIndex = StackIndex + 1;
+				break;
+			}
+		}
+	}
+
+	if (CollapseIndex >= StackSize)
+	{
+		return;
+	}
+
+	// Blend the collapsed layers with their last evaluated pose on top of the previous frozen pose.
+	// Layers that have never been evaluated (e.g. pushed in this frame) have no pose and are dropped without contributing.
+
+	const auto Origin{ GetFrozenBaseOrigin() };
+
+	auto CollapsedView{ FViewModeInfo() };
+	auto bHasCollapsedView{ bHasFrozenBase };
+
+	if (bHasFrozenBase)
+	{
+		CollapsedView = FrozenBaseView;
+		CollapsedView.Location += Origin;
+	}
+
+	for (auto StackIndex{ StackSize - 1 }; StackIndex >= CollapseIndex; --StackIndex)
+	{
+		auto* ViewMode{ ViewModeStack[StackIndex].Get() };
+		check(ViewMode);
+
+		if (ViewMode->HasEvaluatedView())
+		{
+			if (bHasCollapsedView)
+			{
+				CollapsedView.Blend(ViewMode->GetViewModeInfo(), ViewMode->GetBlendWeight());
+			}
+			else
+			{
+				CollapsedView = ViewMode->GetViewModeInfo();
+				bHasCollapsedView = true;
+			}
+		}
+
+		// Collapsed layers are finished as if their blend out had completed
+
+		ViewMode->SetActivationState(EViewModeActivationState::Deactevated);
+	}
+
+	ViewModeStack.RemoveAt(CollapseIndex, StackSize - CollapseIndex);
+
+	if (bHasCollapsedView)
+	{
+		FrozenBaseView = CollapsedView;
+		FrozenBaseView.Location -= Origin;
+		bHasFrozenBase = true;
+	}
+
+	// Without a frozen pose the last remaining layer becomes the base
+
+	else
+	{
+		ViewModeStack.Last()->SetBlendWeight(1.0f);
+	}
+}
+
+FVector UViewModeStack::GetFrozenBaseOrigin() const
+{
+	// The frozen pose follows the target so that it does not lag behind while it is blended out
+
+	const auto* Target{ ViewTarget.IsValid() ? ViewTarget.Get() : GetTypedOuter<AActor>() };
+
+	return Target ? Target->GetActorLocation() : FVector::ZeroVector;
+}
+
 void UViewModeStack::BlendStack(FViewModeInfo& OutViewModeInfo) const
 {
 	const auto LastIndex{ ViewModeStack.Num() - 1 };
@@ -114,14 +310,26 @@ void UViewModeStack::BlendStack(FViewModeInfo& OutViewModeInfo) const
 		return;
 	}
 
-	// Blend in order from the last ViewMode in the Stack.
+	// Blend in order from the last ViewMode in the Stack, or from the frozen pose if layers have been collapsed.
 
 	auto ViewMode{ ViewModeStack[LastIndex] };
 	check(ViewMode);
 
-	OutViewModeInfo = ViewMode->GetViewModeInfo();
+	auto FirstBlendIndex{ LastIndex - 1 };
+
+	if (bHasFrozenBase)
+	{
+		OutViewModeInfo = FrozenBaseView;
+		OutViewModeInfo.Location += GetFrozenBaseOrigin();
+
+		FirstBlendIndex = LastIndex;
+	}
+	else
+	{
+		OutViewModeInfo = ViewMode->GetViewModeInfo();
+	}
 
-	for (auto StackIndex{ LastIndex - 1 }; StackIndex >= 0; --StackIndex)
+	for (auto StackIndex{ FirstBlendIndex }; StackIndex >= 0; --StackIndex)
 	{
 		ViewMode = ViewModeStack[StackIndex];
 		check(ViewMode);
@@ -130,6 +338,86 @@ void UViewModeStack::BlendStack(FViewModeInfo& OutViewModeInfo) const
 	}
 }
 
+#if !UE_BUILD_SHIPPING
+void UViewModeStack::ValidateStack() const
+{
+	if (!CVarStackValidate.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	// Each instance can only be in the Stack once, so the Stack is bounded by the number of instances
+
+	GVEENSURE_MSG(ViewModeStack.Num() <= ViewModeInstances.Num(), TEXT("ViewModeStack: Stack size (%d) exceeds number of instances (%d)"), ViewModeStack.Num(), ViewModeInstances.Num());
+
+	for (auto StackIndex{ 0 }; StackIndex < ViewModeStack.Num(); ++StackIndex)
+	{
+		const auto* ViewMode{ ViewModeStack[StackIndex].Get() };
+		const auto Weight{ ViewMode->GetBlendWeight() };
+
+		GVEENSURE_MSG((Weight >= 0.0f) && (Weight <= 1.0f), TEXT("ViewModeStack: BlendWeight (%f) of [%s] is out of range"), Weight, *GetNameSafe(ViewMode));
+
+		for (auto OtherIndex{ StackIndex + 1 }; OtherIndex < ViewModeStack.Num(); ++OtherIndex)
+		{
+			GVEENSURE_MSG(ViewModeStack[OtherIndex] != ViewMode, TEXT("ViewModeStack: [%s] is in the Stack more than once"), *GetNameSafe(ViewMode));
+		}
+	}
+
+	// The last ViewMode is the base of the blend and must be fully weighted, unless it is blended over the frozen pose
+
+	if ((ViewModeStack.Num() > 0) && !bHasFrozenBase)
+	{
+		const auto BaseWeight{ ViewModeStack.Last()->GetBlendWeight() };
+
+		GVEENSURE_MSG(FMath::IsNearlyEqual(BaseWeight, 1.0f, UE_KINDA_SMALL_NUMBER), TEXT("ViewModeStack: BlendWeight (%f) of the last ViewMode is not 1"), BaseWeight);
+	}
+}
+#endif
+
+bool UViewModeStack::IsViewModeReady(UViewMode* ViewMode)
+{
+	// The first ViewMode is applied immediately since there is nothing else to render
+
+	if (ViewModeStack.IsEmpty() && !bHasFrozenBase)
+	{
+		PendingViewMode = nullptr;
+		return true;
+	}
+
+	// Start loading when a different ViewMode is requested
+
+	if (PendingViewMode != ViewMode)
+	{
+		PendingViewMode = nullptr;
+
+		if (!ViewMode->StartPreload())
+		{
+			return true;
+		}
+
+		PendingViewMode = ViewMode;
+		PendingStartTime = FPlatformTime::Seconds();
+	}
+
+	if (ViewMode->IsPreloadComplete())
+	{
+		PendingViewMode = nullptr;
+		return true;
+	}
+
+	// Give up waiting so that the transition is never stuck
+
+	if ((FPlatformTime::Seconds() - PendingStartTime) >= ViewMode->GetPreloadTimeout())
+	{
+		UE_LOG(LogGVE, Warning, TEXT("ViewModeStack: Preload of [%s] timed out, activating without its assets"), *GetNameSafe(ViewMode->GetClass()));
+
+		PendingViewMode = nullptr;
+		return true;
+	}
+
+	return false;
+}
+
 void UViewModeStack::PushViewMode(TSubclassOf<UViewMode> ViewModeClass)
 {
 	// Whether the newly adapted ViewMode is valid or not
@@ -144,15 +432,28 @@ void UViewModeStack::PushViewMode(TSubclassOf<UViewMode> ViewModeClass)
 	auto* ViewMode{ GetViewModeInstance(ViewModeClass) };
 	check(ViewMode);
 
-	auto StackSize{ ViewModeStack.Num() };
-
 	// Whether the ViewMode you are adding is already at the top of the Stack (i.e., enabled or in progress)
 
-	if ((StackSize > 0) && (ViewModeStack[0] == ViewMode))
+	if ((ViewModeStack.Num() > 0) && (ViewModeStack[0] == ViewMode))
 	{
+		PendingViewMode = nullptr;
 		return;
 	}
 
+	// Keep the current ViewModes applied while the assets of the new one are loading
+
+	if (IsViewModeReady(ViewMode))
+	{
+		ActivateViewMode(ViewMode);
+	}
+}
+
+void UViewModeStack::ActivateViewMode(UViewMode* ViewMode)
+{
+	check(ViewMode);
+
+	auto StackSize{ ViewModeStack.Num() };
+
 	// Check if the ViewMode already exists in the Stack 
 	// and determine the BlendWeight of the newly added ViewMode from the BlendWeight of the ViewMode in the Stack.
 
@@ -200,25 +501,163 @@ void UViewModeStack::PushViewMode(TSubclassOf<UViewMode> ViewModeClass)
 
 	else
 	{
+		RedistributeBlendWeights(ExistingStackIndex, ExistingStackContribution);
+
 		ViewModeStack.RemoveAt(ExistingStackIndex);
 		StackSize--;
 	}
 
 	// Determine the BlendWeight of the newly added ViewMode.
 
-	const auto bShouldBlend{ (ViewMode->GetBlendTime() > 0.0f) && (StackSize > 0) };
+	const auto bShouldBlend{ (ViewMode->GetBlendTime() > 0.0f) && ((StackSize > 0) || bHasFrozenBase) };
 	const auto BlendWeight{ bShouldBlend ? ExistingStackContribution : 1.0f };
 
 	ViewMode->SetBlendWeight(BlendWeight);
 
 	ViewModeStack.Insert(ViewMode, 0);
-	ViewModeStack.Last()->SetBlendWeight(1.0f);
+
+	if (!bHasFrozenBase)
+	{
+		ViewModeStack.Last()->SetBlendWeight(1.0f);
+	}
 
 	ViewMode->SetActivationState(EViewModeActivationState::PreActivate);
+
+#if !UE_BUILD_SHIPPING
+	ValidateStack();
+#endif
+}
+
+void UViewModeStack::RedistributeBlendWeights(int32 RemovedStackIndex, float RemovedContribution)
+{
+	// The removed layer is blended back in from the top with the same contribution,
+	// so the other layers must keep their share of the rest of the pose.
+
+	const auto RemainingShare{ 1.0f - RemovedContribution };
+
+	if (RemainingShare <= UE_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	auto RemainingWeight{ 1.0f };
+	auto DistributedShare{ 0.0f };
+
+	for (auto StackIndex{ 0 }; StackIndex < ViewModeStack.Num(); ++StackIndex)
+	{
+		auto* ViewMode{ ViewModeStack[StackIndex].Get() };
+
+		const auto Weight{ ViewMode->GetBlendWeight() };
+		const auto Contribution{ Weight * RemainingWeight };
+
+		RemainingWeight *= (1.0f - Weight);
+
+		if (StackIndex == RemovedStackIndex)
+		{
+			continue;
+		}
+
+		// Weight that gives the layer its share of the pose once the removed layer is taken out.
+		// The frozen base keeps the rest.
+
+		const auto Share{ Contribution / RemainingShare };
+		const auto AvailableShare{ 1.0f - DistributedShare };
+
+		ViewMode->SetBlendWeight((AvailableShare > UE_SMALL_NUMBER) ? (Share / AvailableShare) : 1.0f);
+
+		DistributedShare += Share;
+	}
+}
+
+void UViewModeStack::ReleaseViewModes()
+{
+	// Execute the pending Actions while the ViewModes still belong to the target
+
+	ActionQueue.Flush();
+
+	auto* World{ GetWorld() };
+	auto* Pool{ World ? World->GetSubsystem<UViewModePoolSubsystem>() : nullptr };
+
+	if (Pool)
+	{
+		for (const auto& ViewMode : ViewModeInstances)
+		{
+			Pool->ReleaseViewMode(ViewMode);
+		}
+	}
+
+	ViewModeStack.Reset();
+	ViewModeInstances.Reset();
+	WarmViewModes.Reset();
+	bHasFrozenBase = false;
+	PendingViewMode = nullptr;
 }
 
 void UViewModeStack::EvaluateStack(float DeltaTime, FViewModeInfo& OutViewModeInfo)
 {
 	UpdateStack(DeltaTime);
+	UpdateWarmViewModes(DeltaTime);
+
+#if !UE_BUILD_SHIPPING
+	ValidateStack();
+#endif
+
 	BlendStack(OutViewModeInfo);
+
+	// Execute the Actions queued by PushViewMode and UpdateStack of this frame
+
+	ActionQueue.Flush();
+}
+
+void UViewModeStack::AddWarmViewMode(TSubclassOf<UViewMode> ViewModeClass)
+{
+	if (ViewModeClass)
+	{
+		WarmViewModes.AddUnique(GetViewModeInstance(ViewModeClass));
+	}
+}
+
+void UViewModeStack::RemoveWarmViewMode(TSubclassOf<UViewMode> ViewModeClass)
+{
+	WarmViewModes.RemoveAll([ViewModeClass](const UViewMode* ViewMode) { return !ViewMode || (ViewMode->GetClass() == ViewModeClass); });
+}
+
+void UViewModeStack::UpdateWarmViewModes(float DeltaTime)
+{
+	const auto WarmUpRate{ CVarStackWarmUpRate.GetValueOnGameThread() };
+
+	if ((WarmUpRate <= 0.0f) || WarmViewModes.IsEmpty())
+	{
+		return;
+	}
+
+	TimeSinceLastWarmUp += DeltaTime;
+
+	if (TimeSinceLastWarmUp < (1.0f / WarmUpRate))
+	{
+		return;
+	}
+
+	// Only one ViewMode is evaluated at a time to spread the cost over the idle frames.
+	// ViewModes in the Stack are already evaluated every frame.
+
+	for (auto Count{ 0 }; Count < WarmViewModes.Num(); ++Count)
+	{
+		NextWarmViewModeIndex = (NextWarmViewModeIndex + 1) % WarmViewModes.Num();
+
+		auto* ViewMode{ WarmViewModes[NextWarmViewModeIndex].Get() };
+
+		if (ViewMode && !ViewModeStack.Contains(ViewMode))
+		{
+			ViewMode->WarmUpViewMode(1.0f / WarmUpRate);
+			break;
+		}
+	}
+
+	TimeSinceLastWarmUp = 0.0f;
+}
+
+void UViewModeStack::EnqueueAction(UViewModeAction* Action, UViewMode* ViewMode, EViewModeActionPhase Phase)
+{
+	ActionQueue.Enqueue(Action, ViewMode, Phase);
 }
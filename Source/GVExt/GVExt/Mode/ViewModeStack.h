@@ -4,18 +4,27 @@
 
 #include "ViewModeTypes.h"
 
+#include "Action/ViewModeActionQueue.h"
+
 #include "ViewModeStack.generated.h"
 
 class UViewMode;
+class AActor;
 
 
 /**
  * Stack to manage and blend ViewModes.
  */
 UCLASS()
-class UViewModeStack : public UObject
+class GVEXT_API UViewModeStack : public UObject
 {
 	GENERATED_BODY()
+
+	//
+	// Builds the Stack directly for the automation tests and benchmarks of the GVExtTests module
+	//
+	friend struct FViewModeStackTestAccess;
+
 public:
 	UViewModeStack(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
@@ -26,28 +35,157 @@ protected:
 	UPROPERTY()
 	TArray<TObjectPtr<UViewMode>> ViewModeStack;
 
+	//
+	// Action calls of the frame, executed at the end of EvaluateStack
+	//
+	FViewModeActionQueue ActionQueue;
+
+	//
+	// Blended pose of the layers collapsed below the Stack, relative to the location of the target.
+	// Valid only when bHasFrozenBase is true.
+	//
+	FViewModeInfo FrozenBaseView;
+
+	bool bHasFrozenBase{ false };
+
+	//
+	// ViewMode waiting for its assets before being added to the Stack
+	//
+	UPROPERTY(Transient)
+	TObjectPtr<UViewMode> PendingViewMode;
+
+	//
+	// Actor viewed by the ViewModes. The owner of the ViewerComponent is used if not set.
+	//
+	UPROPERTY(Transient)
+	TWeakObjectPtr<AActor> ViewTarget;
+
+	double PendingStartTime{ 0.0 };
+
+	//
+	// If true, the ViewModes of this Stack only compute the view and leave the world untouched
+	// (no occluder fades, assist callbacks or Actions), e.g. when evaluated for a capture instead of the player's camera.
+	//
+	bool bSideEffectFree{ false };
+
+	//
+	// ViewModes that are likely to be pushed next and are evaluated in the background while not in the Stack
+	//
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UViewMode>> WarmViewModes;
+
+	int32 NextWarmViewModeIndex{ 0 };
+	float TimeSinceLastWarmUp{ 0.0f };
+
 protected:
 	UViewMode* GetViewModeInstance(TSubclassOf<UViewMode> ViewModeClass);
 
+	/**
+	 * Returns whether the ViewMode can be added to the Stack, starting the loading of its assets if needed
+	 */
+	bool IsViewModeReady(UViewMode* ViewMode);
+
+	/**
+	 * Add the ViewMode to the beginning of the Stack and start Blend.
+	 */
+	void ActivateViewMode(UViewMode* ViewMode);
+
+	/**
+	 * Change the BlendWeight of the other layers so that they keep their share of the pose when the layer is pushed again
+	 */
+	void RedistributeBlendWeights(int32 RemovedStackIndex, float RemovedContribution);
+
 	/**
 	 * Update the ViewMode in the Stack.
 	 */
 	void UpdateStack(float DeltaTime);
 
+	/**
+	 * Collapse the layers deeper than "gvext.Stack.MaxEvaluatedDepth" or whose contribution is below "gvext.Stack.CollapseWeight"
+	 * into a frozen pose that is no longer evaluated
+	 */
+	void CollapseStack();
+
 	/**
 	 * Blend of ViewMode in Stack
 	 */
 	void BlendStack(FViewModeInfo& OutViewModeInfo) const;
 
+	FVector GetFrozenBaseOrigin() const;
+
+	/**
+	 * Evaluate one of the warm ViewModes that are not in the Stack at the rate of "gvext.Stack.WarmUpRate"
+	 */
+	void UpdateWarmViewModes(float DeltaTime);
+
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Check the invariants of the Stack when "gvext.Stack.Validate" is enabled
+	 */
+	void ValidateStack() const;
+#endif
+
 public:
 	/**
 	 * Add a new ViewMode to the beginning of the Stack and start Blend.
+	 * 
+	 * Note:
+	 *	If the ViewMode has assets that are not loaded, it is kept pending until they are loaded or the timeout expires.
+	 *	This is expected to be called every frame with the desired ViewMode.
 	 */
 	void PushViewMode(TSubclassOf<UViewMode> ViewModeClass);
 
+	void SetViewTarget(AActor* InViewTarget) { ViewTarget = InViewTarget; }
+	AActor* GetViewTarget() const { return ViewTarget.Get(); }
+
+	void SetSideEffectFree(bool bInSideEffectFree) { bSideEffectFree = bInSideEffectFree; }
+	bool IsSideEffectFree() const { return bSideEffectFree; }
+
+	/**
+	 * Flag the ViewMode as likely to be pushed next (e.g. ADS while a weapon is equipped).
+	 * It is evaluated at a low rate while not in the Stack so that its penetration state is ready when it is pushed.
+	 */
+	void AddWarmViewMode(TSubclassOf<UViewMode> ViewModeClass);
+	void RemoveWarmViewMode(TSubclassOf<UViewMode> ViewModeClass);
+
+	/**
+	 * Returns the ViewMode waiting for its assets, if any
+	 */
+	UViewMode* GetPendingViewMode() const { return PendingViewMode; }
+
+	/**
+	 * Returns the number of ViewModes evaluated in the Stack
+	 */
+	int32 GetStackDepth() const { return ViewModeStack.Num(); }
+
+	/**
+	 * Returns the ViewModes in the Stack, from the top to the base
+	 */
+	TConstArrayView<TObjectPtr<UViewMode>> GetStackViewModes() const { return ViewModeStack; }
+
+	/**
+	 * Returns the number of ViewMode instances created by this Stack
+	 */
+	int32 GetNumViewModeInstances() const { return ViewModeInstances.Num(); }
+
+	/**
+	 * Returns whether the layers below the Stack have been collapsed into a frozen pose
+	 */
+	bool HasFrozenBase() const { return bHasFrozenBase; }
+
 	/**
 	 * Called by ViewerComponent to update Stack and return final output data
 	 */
 	void EvaluateStack(float DeltaTime, FViewModeInfo& OutViewModeInfo);
 
+	/**
+	 * Return all ViewMode instances to the pool of the world and empty the Stack
+	 */
+	void ReleaseViewModes();
+
+	/**
+	 * Queue the call of the Action until the end of the evaluation of this frame
+	 */
+	void EnqueueAction(UViewModeAction* Action, UViewMode* ViewMode, EViewModeActionPhase Phase);
+
 };
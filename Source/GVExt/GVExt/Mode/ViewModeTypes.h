@@ -42,10 +42,64 @@ enum class EViewModeActivationState : uint8
 };
 
 
+/**
+ * Quality level of the camera evaluation, each level also includes the reductions of the levels above it
+ */
+UENUM(BlueprintType)
+enum class EViewQualityLevel : uint8
+{
+	// Full quality
+	Full,
+
+	// Predictive avoidance feelers are disabled
+	Reduced,
+
+	// Feeler trace intervals are lengthened and curves are evaluated from a lookup table
+	Low,
+
+	// Penetration traces are only updated every other frame
+	Minimal,
+
+	COUNT	UMETA(Hidden)
+};
+
+
+/**
+ * How the ViewMode responds to geometry between the view target and the camera
+ */
+UENUM(BlueprintType)
+enum class EViewModeCollisionResponse : uint8
+{
+	// Pull the camera in front of the blocking geometry
+	PullIn,
+
+	// Keep the camera distance and fade the occluding primitives
+	FadeOccluders,
+
+	COUNT	UMETA(Hidden)
+};
+
+
+/**
+ * Source of the collision used by the ViewMode to prevent camera penetration
+ */
+UENUM(BlueprintType)
+enum class EViewModeCollisionBackend : uint8
+{
+	// Sweep all feelers against the physics scene
+	PhysicsScene,
+
+	// Sphere trace the baked distance field for the static geometry and sweep the physics scene only for movable primitives
+	DistanceField,
+
+	COUNT	UMETA(Hidden)
+};
+
+
 /**
  * Data generated by the ViewMode used to blend the ViewMode
  */
-struct FViewModeInfo
+struct GVEXT_API FViewModeInfo
 {
 public:
 	FViewModeInfo();
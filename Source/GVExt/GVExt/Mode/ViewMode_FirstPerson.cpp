@@ -2,6 +2,11 @@
 
 #include "ViewMode_FirstPerson.h"
 
+#include "Mode/ViewModeEvaluation.h"
+#include "GVExtLogs.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
 #include "GameFramework/Character.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ViewMode_FirstPerson)
@@ -13,12 +18,41 @@ UViewMode_FirstPerson::UViewMode_FirstPerson(const FObjectInitializer& ObjectIni
 }
 
 
+void UViewMode_FirstPerson::ResetViewMode()
+{
+	Super::ResetViewMode();
+
+	CrouchOffsetBlendPct = 1.0f;
+	InitialCrouchOffset = FVector::ZeroVector;
+	TargetCrouchOffset = FVector::ZeroVector;
+	CurrentCrouchOffset = FVector::ZeroVector;
+
+	PivotMesh.Reset();
+	PivotMeshAsset.Reset();
+	bPivotBoneResolved = false;
+	PivotBoneIndex = INDEX_NONE;
+	PivotSocketLocalTransform = FTransform::Identity;
+	bHasPivotBoneSample = false;
+	PivotOffset = FVector::ZeroVector;
+	bHasPivotOffset = false;
+}
+
+
+void UViewMode_FirstPerson::EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const
+{
+	Super::EvaluateView(Input, OutView);
+
+	OutView.Location.Z += Input.CrouchOffset;
+}
+
 void UViewMode_FirstPerson::UpdateView(float DeltaTime)
 {
 	UpdateForTarget(DeltaTime);
 	UpdateCrouchOffset(DeltaTime);
 
-	auto PivotLocation{ GetPivotLocation() + CurrentCrouchOffset };
+	const auto CapsulePivotLocation{ GetPivotLocation() };
+
+	auto PivotLocation{ PivotBoneName.IsNone() ? (CapsulePivotLocation + CurrentCrouchOffset) : UpdateBonePivot(DeltaTime, CapsulePivotLocation) };
 	auto PivotRotation{ GetPivotRotation() };
 
 	PivotRotation.Pitch = FMath::ClampAngle(PivotRotation.Pitch, ViewPitchMin, ViewPitchMax);
@@ -67,3 +101,119 @@ void UViewMode_FirstPerson::UpdateCrouchOffset(float DeltaTime)
 		CrouchOffsetBlendPct = 1.0f;
 	}
 }
+
+
+FVector UViewMode_FirstPerson::UpdateBonePivot(float DeltaTime, const FVector& CapsulePivotLocation)
+{
+	const auto* Target{ GetTarget() };
+	const auto TargetRotation{ Target ? Target->GetActorQuat() : FQuat::Identity };
+
+	// Offsets are kept in the space of the target so that the smoothing does not lag behind its rotation.
+	// The crouch offset is replaced by the bone as the animation already lowers it.
+
+	auto TargetOffset{ TargetRotation.UnrotateVector(CurrentCrouchOffset) };
+
+	FVector BoneLocation;
+	if (SamplePivotBone(BoneLocation))
+	{
+		const auto BoneOffset{ TargetRotation.UnrotateVector(BoneLocation - CapsulePivotLocation) };
+
+		TargetOffset = FMath::Lerp(TargetOffset, BoneOffset, PivotBoneWeight);
+	}
+
+	if (!bHasPivotOffset || bResetInterpolation || (PivotBoneInterpSpeed <= 0.0f))
+	{
+		PivotOffset = TargetOffset;
+	}
+	else
+	{
+		PivotOffset = FMath::VInterpTo(PivotOffset, TargetOffset, DeltaTime, PivotBoneInterpSpeed);
+	}
+
+	bHasPivotOffset = true;
+
+	return CapsulePivotLocation + TargetRotation.RotateVector(PivotOffset);
+}
+
+void UViewMode_FirstPerson::ResolvePivotBone()
+{
+	bPivotBoneResolved = false;
+
+	PivotMesh.Reset();
+	PivotMeshAsset.Reset();
+	PivotBoneIndex = INDEX_NONE;
+	PivotSocketLocalTransform = FTransform::Identity;
+	bHasPivotBoneSample = false;
+
+	auto* Target{ GetTarget() };
+	auto* TargetCharacter{ Cast<ACharacter>(Target) };
+	auto* Mesh{ TargetCharacter ? TargetCharacter->GetMesh() : (Target ? Target->FindComponentByClass<USkeletalMeshComponent>() : nullptr) };
+
+	if (!Mesh || !Mesh->GetSkinnedAsset())
+	{
+		return;
+	}
+
+	PivotMesh = Mesh;
+	PivotMeshAsset = Mesh->GetSkinnedAsset();
+
+	// Sockets are resolved to their bone once so that only the bone has to be read every frame
+
+	auto BoneName{ PivotBoneName };
+
+	if (const auto* Socket{ Mesh->GetSocketByName(PivotBoneName) })
+	{
+		BoneName = Socket->BoneName;
+		PivotSocketLocalTransform = Socket->GetSocketLocalTransform();
+	}
+
+	PivotBoneIndex = Mesh->GetBoneIndex(BoneName);
+
+	// The result is kept even if the bone is not found so that a misconfigured name is not searched every frame.
+	// It is resolved again when the mesh or its asset changes (e.g. the mesh is set after spawn).
+
+	bPivotBoneResolved = true;
+
+	if (PivotBoneIndex == INDEX_NONE)
+	{
+		UE_LOG(LogGVE, Warning, TEXT("[%s] PivotBoneName [%s] is neither a socket nor a bone of [%s]"), *GetNameSafe(GetClass()), *PivotBoneName.ToString(), *GetNameSafe(Mesh->GetSkinnedAsset()));
+	}
+}
+
+bool UViewMode_FirstPerson::SamplePivotBone(FVector& OutLocation)
+{
+	auto* Mesh{ PivotMesh.Get() };
+
+	if (!bPivotBoneResolved || !Mesh || (Mesh->GetSkinnedAsset() != PivotMeshAsset.Get()))
+	{
+		ResolvePivotBone();
+		Mesh = PivotMesh.Get();
+	}
+
+	if (!Mesh || (PivotBoneIndex == INDEX_NONE))
+	{
+		return false;
+	}
+
+	// Never wait for the animation task, the bone of the last completed pose is reused while it is running
+
+	if (!Mesh->IsRunningParallelEvaluation())
+	{
+		const auto& ComponentSpaceTransforms{ Mesh->GetComponentSpaceTransforms() };
+
+		if (ComponentSpaceTransforms.IsValidIndex(PivotBoneIndex))
+		{
+			PivotBoneComponentLocation = (PivotSocketLocalTransform * ComponentSpaceTransforms[PivotBoneIndex]).GetLocation();
+			bHasPivotBoneSample = true;
+		}
+	}
+
+	if (!bHasPivotBoneSample)
+	{
+		return false;
+	}
+
+	OutLocation = Mesh->GetComponentTransform().TransformPosition(PivotBoneComponentLocation);
+
+	return true;
+}
@@ -6,6 +6,9 @@
 
 #include "ViewMode_FirstPerson.generated.h"
 
+class USkeletalMeshComponent;
+class USkinnedAsset;
+
 
 /**
  * ViewMode base class for FPP viewpoint
@@ -24,12 +27,65 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "First Person")
 	float CrouchOffsetBlendMultiplier{ 8.0f };
 
+	//
+	// Bone or socket of the target's mesh used as the pivot instead of the eye height of the capsule (e.g. a head bone for head-bob).
+	// The capsule pivot is used if not set.
+	//
+	// Note:
+	//	The bone is read from the last completed pose and never waits for the animation evaluation.
+	//	The capsule pivot is used while the pose is not available.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "First Person|Pivot")
+	FName PivotBoneName{ NAME_None };
+
+	//
+	// How much the bone pivot is used over the capsule pivot
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "First Person|Pivot", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float PivotBoneWeight{ 1.0f };
+
+	//
+	// Speed at which the pivot follows the bone. 0 follows it immediately.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "First Person|Pivot", meta = (ClampMin = "0.0"))
+	float PivotBoneInterpSpeed{ 0.0f };
+
 protected:
 	float CrouchOffsetBlendPct{ 1.0f };
 	FVector InitialCrouchOffset{ FVector::ZeroVector };
 	FVector TargetCrouchOffset{ FVector::ZeroVector };
 	FVector CurrentCrouchOffset{ FVector::ZeroVector };
 
+	//
+	// Mesh and asset in which PivotBoneName was last looked up.
+	// If true, the lookup is not repeated until either one changes, even if the bone was not found.
+	//
+	TWeakObjectPtr<USkeletalMeshComponent> PivotMesh;
+	TWeakObjectPtr<const USkinnedAsset> PivotMeshAsset;
+	bool bPivotBoneResolved{ false };
+
+	//
+	// Index of the bone that PivotBoneName refers to, and the offset of the socket from the bone
+	//
+	int32 PivotBoneIndex{ INDEX_NONE };
+	FTransform PivotSocketLocalTransform{ FTransform::Identity };
+
+	//
+	// Location of the pivot bone in the space of the mesh, from the last completed pose
+	//
+	FVector PivotBoneComponentLocation{ FVector::ZeroVector };
+	bool bHasPivotBoneSample{ false };
+
+	//
+	// Smoothed offset of the pivot from the capsule pivot in the space of the target
+	//
+	FVector PivotOffset{ FVector::ZeroVector };
+	bool bHasPivotOffset{ false };
+
+public:
+	virtual void ResetViewMode() override;
+	virtual void EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const override;
+
 protected:
 	virtual void UpdateView(float DeltaTime) override;
 	void UpdateForTarget(float DeltaTime);
@@ -37,4 +93,22 @@ protected:
 	void SetTargetCrouchOffset(FVector NewTargetOffset);
 	void UpdateCrouchOffset(float DeltaTime);
 
+	/**
+	 * Returns the pivot blended between the capsule pivot and the pivot bone
+	 */
+	FVector UpdateBonePivot(float DeltaTime, const FVector& CapsulePivotLocation);
+
+	/**
+	 * Find the mesh of the target and cache the index of the pivot bone
+	 *
+	 * Note:
+	 *	It is only marked as resolved when the bone is found, so a mesh assigned later is still picked up.
+	 */
+	void ResolvePivotBone();
+
+	/**
+	 * Returns the world location of the pivot bone from the last completed pose, false if no pose is available
+	 */
+	bool SamplePivotBone(FVector& OutLocation);
+
 };
@@ -0,0 +1,278 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewMode_GroupFraming.h"
+
+#include "ViewAssistInterface.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewMode_GroupFraming)
+
+
+UViewMode_GroupFraming::UViewMode_GroupFraming(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+
+void UViewMode_GroupFraming::ResetViewMode()
+{
+	Super::ResetViewMode();
+
+	TaggedTargets.Reset();
+	FramingTargets.Reset();
+	FramingPositions.Reset();
+	CurrentCenter = FVector::ZeroVector;
+	CurrentDistance = 0.0f;
+	bHasFraming = false;
+}
+
+void UViewMode_GroupFraming::PreActivateMode()
+{
+	Super::PreActivateMode();
+
+	// Search the tagged actors once per activation instead of every frame
+
+	TaggedTargets.Reset();
+
+	auto* World{ GetWorld() };
+
+	if (World && !FramingActorTag.IsNone())
+	{
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (It->ActorHasTag(FramingActorTag))
+			{
+				TaggedTargets.Add(*It);
+			}
+		}
+	}
+
+	bHasFraming = false;
+}
+
+
+void UViewMode_GroupFraming::UpdateView(float DeltaTime)
+{
+	FramingTargets.Reset();
+	GatherFramingTargets(FramingTargets);
+
+	if (FramingTargets.Num() > MaxFramingTargets)
+	{
+		FramingTargets.SetNum(MaxFramingTargets);
+	}
+
+	if (FramingTargets.IsEmpty())
+	{
+		Super::UpdateView(DeltaTime);
+		return;
+	}
+
+	// Gather the locations into a contiguous buffer relative to the first target to keep single precision
+
+	const auto Origin{ FramingTargets[0]->GetActorLocation() };
+
+	FramingPositions.Reset();
+
+	for (const auto* Target : FramingTargets)
+	{
+		FramingPositions.Add(FVector4f(FVector3f(Target->GetActorLocation() - Origin), 0.0f));
+	}
+
+	FVector3f LocalCenter;
+	float Radius;
+	ComputeFramingSphere(LocalCenter, Radius);
+
+	auto TargetFieldOfView{ FieldOfView };
+	const auto TargetCenter{ Origin + FVector(LocalCenter) };
+	const auto TargetDistance{ FitDistanceToSphere(Radius + TargetRadius, TargetFieldOfView) };
+
+	// Follow the group smoothly
+
+	if (!bHasFraming || bResetInterpolation || (FramingInterpSpeed <= 0.0f))
+	{
+		CurrentCenter = TargetCenter;
+		CurrentDistance = TargetDistance;
+	}
+	else
+	{
+		CurrentCenter = FMath::VInterpTo(CurrentCenter, TargetCenter, DeltaTime, FramingInterpSpeed);
+		CurrentDistance = FMath::FInterpTo(CurrentDistance, TargetDistance, DeltaTime, FramingInterpSpeed);
+	}
+
+	bHasFraming = true;
+
+	auto ControlRotation{ GetPivotRotation() };
+	ControlRotation.Pitch = FMath::ClampAngle(ControlRotation.Pitch, ViewPitchMin, ViewPitchMax);
+
+	auto CameraRotation{ FramingRotation };
+
+	if (bFollowControlYaw)
+	{
+		CameraRotation.Yaw += ControlRotation.Yaw;
+	}
+
+	auto CameraLocation{ CurrentCenter - (CameraRotation.Vector() * CurrentDistance) };
+
+	if (bPreventPenetration)
+	{
+		PreventPenetration(CurrentCenter, CameraLocation);
+	}
+
+	View.Location = CameraLocation;
+	View.Rotation = CameraRotation;
+	View.ControlRotation = ControlRotation;
+	View.FieldOfView = TargetFieldOfView;
+
+	// The targets are only valid in this frame
+
+	FramingTargets.Reset();
+}
+
+
+void UViewMode_GroupFraming::GatherFramingTargets(TArray<AActor*>& OutTargets) const
+{
+	// Actors provided by the target
+
+	auto* TargetPawn{ GetTargetPawn() };
+	auto* TargetController{ TargetPawn ? TargetPawn->GetController() : nullptr };
+
+	for (const auto* Assist : { Cast<IViewAssistInterface>(TargetPawn), Cast<IViewAssistInterface>(TargetController) })
+	{
+		if (Assist)
+		{
+			Assist->GetCameraFramingTargets(OutTargets);
+
+			if (!OutTargets.IsEmpty())
+			{
+				OutTargets.RemoveAll([](const AActor* Actor) { return !IsValid(Actor); });
+				return;
+			}
+		}
+	}
+
+	// The target and the tagged actors
+
+	if (auto* Target{ GetTarget() })
+	{
+		OutTargets.Add(Target);
+	}
+
+	for (const auto& TaggedTarget : TaggedTargets)
+	{
+		if (auto* Actor{ TaggedTarget.Get() })
+		{
+			OutTargets.AddUnique(Actor);
+		}
+	}
+}
+
+void UViewMode_GroupFraming::ComputeFramingSphere(FVector3f& OutCenter, float& OutRadius) const
+{
+	// First pass: axis aligned bounds of all locations
+
+	auto BoundsMin{ VectorSetFloat1(TNumericLimits<float>::Max()) };
+	auto BoundsMax{ VectorNegate(BoundsMin) };
+
+	for (const auto& Position : FramingPositions)
+	{
+		const auto Value{ VectorLoad(&Position.X) };
+
+		BoundsMin = VectorMin(BoundsMin, Value);
+		BoundsMax = VectorMax(BoundsMax, Value);
+	}
+
+	const auto Center{ VectorMultiply(VectorAdd(BoundsMin, BoundsMax), VectorSetFloat1(0.5f)) };
+
+	// Second pass: farthest location from the center of the bounds
+
+	auto MaxDistanceSqr{ VectorZeroFloat() };
+
+	for (const auto& Position : FramingPositions)
+	{
+		const auto Offset{ VectorSubtract(VectorLoad(&Position.X), Center) };
+
+		MaxDistanceSqr = VectorMax(MaxDistanceSqr, VectorDot3(Offset, Offset));
+	}
+
+	FVector4f CenterValue;
+	VectorStore(Center, &CenterValue.X);
+
+	auto RadiusSqr{ 0.0f };
+	VectorStoreFloat1(MaxDistanceSqr, &RadiusSqr);
+
+	OutCenter = FVector3f(CenterValue.X, CenterValue.Y, CenterValue.Z);
+	OutRadius = FMath::Sqrt(RadiusSqr);
+}
+
+float UViewMode_GroupFraming::FitDistanceToSphere(float Radius, float& OutFieldOfView) const
+{
+	// The sphere fits when it is inside the narrower of the horizontal and vertical half angles
+
+	const auto GetHalfAngle
+	{
+		[this](float HorizontalFieldOfView)
+		{
+			const auto HorizontalHalfAngle{ FMath::DegreesToRadians(HorizontalFieldOfView * 0.5f) };
+			const auto VerticalHalfAngle{ FMath::Atan(FMath::Tan(HorizontalHalfAngle) / FMath::Max(AspectRatio, 0.1f)) };
+
+			return FMath::Min(HorizontalHalfAngle, VerticalHalfAngle);
+		}
+	};
+
+	const auto RequiredDistance{ Radius / FMath::Sin(GetHalfAngle(OutFieldOfView)) };
+	const auto Distance{ FMath::Clamp(RequiredDistance, MinDistance, FMath::Max(MinDistance, MaxDistance)) };
+
+	// Widen the field of view for the part of the group that does not fit at the maximum distance
+
+	if (bWidenFieldOfView && (RequiredDistance > Distance) && (Distance > UE_KINDA_SMALL_NUMBER))
+	{
+		const auto RequiredHalfAngle{ FMath::Asin(FMath::Min(Radius / Distance, 1.0f)) };
+
+		// Convert back from the narrower half angle to the horizontal field of view
+
+		const auto HorizontalHalfAngle{ (AspectRatio >= 1.0f) ? FMath::Atan(FMath::Tan(RequiredHalfAngle) * AspectRatio) : RequiredHalfAngle };
+
+		OutFieldOfView = FMath::Clamp(FMath::RadiansToDegrees(HorizontalHalfAngle * 2.0f), OutFieldOfView, MaxFieldOfView);
+	}
+
+	return Distance;
+}
+
+void UViewMode_GroupFraming::PreventPenetration(const FVector& Center, FVector& CameraLocation) const
+{
+	auto* World{ GetWorld() };
+
+	if (!World)
+	{
+		return;
+	}
+
+	const auto Ray{ CameraLocation - Center };
+	const auto RayLength{ Ray.Size() };
+
+	if (RayLength <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	// The framed actors never block the camera
+
+	auto Params{ FCollisionQueryParams(SCENE_QUERY_STAT(GroupFramingPen), false) };
+
+	for (const auto* Target : FramingTargets)
+	{
+		Params.AddIgnoredActor(Target);
+	}
+
+	FHitResult Hit;
+	if (World->SweepSingleByChannel(Hit, Center, CameraLocation, FQuat::Identity, ECC_Camera, FCollisionShape::MakeSphere(PenetrationProbeRadius), Params))
+	{
+		const auto DistBlockedPct{ FMath::Clamp<float>(((Hit.Location - Center).Size() - CollisionPushOutDistance) / RayLength, 0.0f, 1.0f) };
+
+		CameraLocation = Center + Ray * DistBlockedPct;
+	}
+}
@@ -0,0 +1,136 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewMode.h"
+
+#include "ViewMode_GroupFraming.generated.h"
+
+
+/**
+ * ViewMode base class for a camera that keeps a group of actors in frame (e.g. party or co-op levels)
+ * 
+ * Note:
+ *	The locations of the targets are gathered into a contiguous buffer every frame,
+ *	and the bounding sphere is computed from it with vector instructions in two passes.
+ *	The distance (and optionally the field of view) is then fitted to the sphere, and a single sweep prevents penetration.
+ */
+UCLASS(Abstract, Blueprintable)
+class GVEXT_API UViewMode_GroupFraming : public UViewMode
+{
+	GENERATED_BODY()
+public:
+	UViewMode_GroupFraming(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	//
+	// Tag of the actors to be framed when the target does not provide them through IViewAssistInterface.
+	// The actors are searched once when the ViewMode is activated.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing")
+	FName FramingActorTag{ NAME_None };
+
+	//
+	// Maximum number of actors framed, the rest are ignored
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "1"))
+	int32 MaxFramingTargets{ 64 };
+
+	//
+	// Radius added around the location of each actor so that the whole body stays in frame
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "0.0", Units = "cm"))
+	float TargetRadius{ 100.0f };
+
+	//
+	// Rotation of the camera. Yaw is added to the yaw of the control rotation if bFollowControlYaw is true.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing")
+	FRotator FramingRotation{ -50.0f, 0.0f, 0.0f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Framing")
+	bool bFollowControlYaw{ false };
+
+	//
+	// Aspect ratio of the view used to derive the vertical field of view
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "0.1"))
+	float AspectRatio{ 16.0f / 9.0f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "0.0", Units = "cm"))
+	float MinDistance{ 500.0f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "0.0", Units = "cm"))
+	float MaxDistance{ 3000.0f };
+
+	//
+	// If true, the field of view is widened when the group does not fit at MaxDistance
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing")
+	bool bWidenFieldOfView{ true };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (EditCondition = "bWidenFieldOfView", UIMin = "5.0", UIMax = "170", ClampMin = "5.0", ClampMax = "170.0"))
+	float MaxFieldOfView{ 110.0f };
+
+	//
+	// Speed at which the center and the distance follow the group. 0 follows immediately.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Framing", meta = (ClampMin = "0.0"))
+	float FramingInterpSpeed{ 4.0f };
+
+	//
+	// If true, a single sweep from the center of the group keeps the camera out of the world
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Collision")
+	bool bPreventPenetration{ true };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Collision", meta = (EditCondition = "bPreventPenetration", ClampMin = "0.0", Units = "cm"))
+	float PenetrationProbeRadius{ 14.0f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Collision", meta = (EditCondition = "bPreventPenetration", ClampMin = "0.0", Units = "cm"))
+	float CollisionPushOutDistance{ 2.0f };
+
+protected:
+	//
+	// Actors found by FramingActorTag on activation
+	//
+	TArray<TWeakObjectPtr<AActor>> TaggedTargets;
+
+	//
+	// Targets and their locations relative to the first target, reused every frame
+	//
+	TArray<AActor*> FramingTargets;
+	TArray<FVector4f> FramingPositions;
+
+	FVector CurrentCenter{ FVector::ZeroVector };
+	float CurrentDistance{ 0.0f };
+	bool bHasFraming{ false };
+
+public:
+	virtual void ResetViewMode() override;
+
+protected:
+	virtual void PreActivateMode() override;
+	virtual void UpdateView(float DeltaTime) override;
+
+	/**
+	 * Collect the actors to be framed from the target or from the tagged actors
+	 */
+	virtual void GatherFramingTargets(TArray<AActor*>& OutTargets) const;
+
+	/**
+	 * Compute the bounding sphere of FramingPositions relative to the first target
+	 */
+	void ComputeFramingSphere(FVector3f& OutCenter, float& OutRadius) const;
+
+	/**
+	 * Returns the distance at which a sphere of the radius fits in the view, widening OutFieldOfView if needed
+	 */
+	float FitDistanceToSphere(float Radius, float& OutFieldOfView) const;
+
+	/**
+	 * Pull the camera in front of the geometry between the center of the group and the camera
+	 */
+	void PreventPenetration(const FVector& Center, FVector& CameraLocation) const;
+
+};
@@ -0,0 +1,318 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewMode_Spline.h"
+
+#include "ViewAssistInterface.h"
+
+#include "Components/SplineComponent.h"
+#include "EngineUtils.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewMode_Spline)
+
+
+UViewMode_Spline::UViewMode_Spline(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+
+void UViewMode_Spline::ResetViewMode()
+{
+	Super::ResetViewMode();
+
+	Spline.Reset();
+	SampleLocations.Reset();
+	SampleDistances.Reset();
+	SplineLength = 0.0f;
+	bClosedLoop = false;
+	bSplineLookupFailed = false;
+	LastClosestSample = INDEX_NONE;
+	CurrentCameraDistance = 0.0f;
+}
+
+void UViewMode_Spline::PreActivateMode()
+{
+	Super::PreActivateMode();
+
+	// Build the lookup table once per activation.
+	// The search is only continued from the previous result if the view was warmed up on the same spline.
+
+	if (RefreshSpline() || !HasEvaluatedView())
+	{
+		LastClosestSample = INDEX_NONE;
+	}
+
+	bSplineLookupFailed = !Spline.IsValid();
+}
+
+void UViewMode_Spline::PreWarmUpView()
+{
+	Super::PreWarmUpView();
+
+	// Warm-up can happen before the first activation, when the lookup table has not been built yet.
+	// A failed lookup is not repeated every warm-up since it may iterate all actors of the world.
+
+	if (!Spline.IsValid() && !bSplineLookupFailed)
+	{
+		if (RefreshSpline())
+		{
+			LastClosestSample = INDEX_NONE;
+		}
+
+		bSplineLookupFailed = !Spline.IsValid();
+	}
+}
+
+bool UViewMode_Spline::RefreshSpline()
+{
+	const auto* NewSpline{ FindSpline() };
+
+	if (NewSpline == Spline.Get())
+	{
+		return false;
+	}
+
+	Spline = NewSpline;
+
+	SampleLocations.Reset();
+	SampleDistances.Reset();
+
+	if (NewSpline)
+	{
+		BuildLookupTable(*NewSpline);
+	}
+
+	return true;
+}
+
+
+void UViewMode_Spline::UpdateView(float DeltaTime)
+{
+	const auto* CurrentSpline{ Spline.Get() };
+
+	// Behave like the base ViewMode without a spline
+
+	if (!CurrentSpline || (SampleLocations.Num() < 2))
+	{
+		Super::UpdateView(DeltaTime);
+		return;
+	}
+
+	const auto& SplineTransform{ CurrentSpline->GetComponentTransform() };
+
+	const auto PivotLocation{ GetPivotLocation() };
+	auto PivotRotation{ GetPivotRotation() };
+
+	PivotRotation.Pitch = FMath::ClampAngle(PivotRotation.Pitch, ViewPitchMin, ViewPitchMax);
+
+	// Progress of the target along the spline
+
+	const auto bFirstUpdate{ LastClosestSample == INDEX_NONE };
+	const auto TargetDistance{ FindClosestDistance(SplineTransform.InverseTransformPosition(PivotLocation)) };
+
+	auto DesiredDistance{ TargetDistance + ProgressOffset };
+
+	if (!bClosedLoop)
+	{
+		DesiredDistance = FMath::Clamp(DesiredDistance, 0.0f, SplineLength);
+	}
+
+	if (bFirstUpdate || bResetInterpolation || (ProgressInterpSpeed <= 0.0f))
+	{
+		CurrentCameraDistance = DesiredDistance;
+	}
+	else
+	{
+		auto DistanceDelta{ DesiredDistance - CurrentCameraDistance };
+
+		// Take the shortest way around closed splines
+
+		if (bClosedLoop)
+		{
+			DistanceDelta = FMath::Fmod(DistanceDelta + (SplineLength * 1.5f), SplineLength) - (SplineLength * 0.5f);
+		}
+
+		CurrentCameraDistance += DistanceDelta * FMath::Clamp(DeltaTime * ProgressInterpSpeed, 0.0f, 1.0f);
+	}
+
+	const auto CameraLocation{ SplineTransform.TransformPosition(GetLocationAtDistance(CurrentCameraDistance)) };
+
+	// Look at the target or along the spline
+
+	auto CameraRotation{ PivotRotation };
+
+	if (bLookAtTarget)
+	{
+		CameraRotation = (PivotLocation - CameraLocation).Rotation();
+	}
+	else
+	{
+		const auto LocalDirection{ GetLocationAtDistance(CurrentCameraDistance + SampleSpacing) - GetLocationAtDistance(CurrentCameraDistance - SampleSpacing) };
+
+		CameraRotation = SplineTransform.TransformVectorNoScale(LocalDirection).Rotation();
+	}
+
+	View.Location = CameraLocation;
+	View.Rotation = CameraRotation;
+	View.ControlRotation = PivotRotation;
+	View.FieldOfView = FieldOfView;
+}
+
+
+const USplineComponent* UViewMode_Spline::FindSpline() const
+{
+	// Spline provided by the target
+
+	auto* TargetPawn{ GetTargetPawn() };
+	auto* TargetController{ TargetPawn ? TargetPawn->GetController() : nullptr };
+
+	for (const auto* Assist : { Cast<IViewAssistInterface>(TargetPawn), Cast<IViewAssistInterface>(TargetController) })
+	{
+		if (Assist)
+		{
+			if (const auto* AssistSpline{ Assist->GetCameraRailSpline() })
+			{
+				return AssistSpline;
+			}
+		}
+	}
+
+	// Spline of the actor with the tag
+
+	auto* World{ GetWorld() };
+
+	if (World && !SplineActorTag.IsNone())
+	{
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (It->ActorHasTag(SplineActorTag))
+			{
+				if (const auto* TaggedSpline{ It->FindComponentByClass<USplineComponent>() })
+				{
+					return TaggedSpline;
+				}
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+void UViewMode_Spline::BuildLookupTable(const USplineComponent& InSpline)
+{
+	SplineLength = InSpline.GetSplineLength();
+	bClosedLoop = InSpline.IsClosedLoop();
+
+	const auto NumSamples{ FMath::Max(2, FMath::CeilToInt32(SplineLength / FMath::Max(SampleSpacing, 1.0f)) + 1) };
+
+	SampleLocations.SetNumUninitialized(NumSamples);
+	SampleDistances.SetNumUninitialized(NumSamples);
+
+	for (auto Index{ 0 }; Index < NumSamples; ++Index)
+	{
+		const auto Distance{ (SplineLength * Index) / (NumSamples - 1) };
+
+		SampleDistances[Index] = Distance;
+		SampleLocations[Index] = InSpline.GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::Local);
+	}
+}
+
+float UViewMode_Spline::FindClosestDistance(const FVector& LocalLocation)
+{
+	const auto NumSegments{ SampleLocations.Num() - 1 };
+
+	auto BestDistanceSqr{ TNumericLimits<double>::Max() };
+	auto BestSegment{ 0 };
+	auto BestDistance{ 0.0f };
+
+	// Search only around the previous result
+
+	if (LastClosestSample != INDEX_NONE)
+	{
+		// The window never covers more than half of the table so that a segment is not visited twice
+
+		const auto Window{ FMath::Clamp(SearchWindow, 0, NumSegments / 2) };
+
+		auto FirstSegment{ LastClosestSample - Window };
+		auto LastSegment{ LastClosestSample + Window };
+
+		if (!bClosedLoop)
+		{
+			FirstSegment = FMath::Max(FirstSegment, 0);
+			LastSegment = FMath::Min(LastSegment, NumSegments - 1);
+		}
+
+		BestDistance = SearchClosestDistance(LocalLocation, FirstSegment, LastSegment, BestDistanceSqr, BestSegment);
+	}
+
+	// Search the whole table the first time or when the target left the window (e.g. teleport or respawn)
+
+	if (BestDistanceSqr > FMath::Square(static_cast<double>(FullSearchDistance)))
+	{
+		BestDistance = SearchClosestDistance(LocalLocation, 0, NumSegments - 1, BestDistanceSqr, BestSegment);
+	}
+
+	LastClosestSample = BestSegment;
+
+	return BestDistance;
+}
+
+float UViewMode_Spline::SearchClosestDistance(const FVector& LocalLocation, int32 FirstSegment, int32 LastSegment, double& OutDistanceSqr, int32& OutSegment) const
+{
+	const auto NumSegments{ SampleLocations.Num() - 1 };
+
+	auto BestDistanceSqr{ TNumericLimits<double>::Max() };
+	auto BestSegment{ 0 };
+	auto BestDistance{ 0.0f };
+
+	for (auto Segment{ FirstSegment }; Segment <= LastSegment; ++Segment)
+	{
+		const auto Index{ ((Segment % NumSegments) + NumSegments) % NumSegments };
+
+		const auto& SegmentStart{ SampleLocations[Index] };
+		const auto& SegmentEnd{ SampleLocations[Index + 1] };
+
+		const auto ClosestPoint{ FMath::ClosestPointOnSegment(LocalLocation, SegmentStart, SegmentEnd) };
+		const auto DistanceSqr{ FVector::DistSquared(LocalLocation, ClosestPoint) };
+
+		if (DistanceSqr < BestDistanceSqr)
+		{
+			const auto SegmentLength{ FVector::Dist(SegmentStart, SegmentEnd) };
+			const auto Alpha{ (SegmentLength > UE_KINDA_SMALL_NUMBER) ? (FVector::Dist(SegmentStart, ClosestPoint) / SegmentLength) : 0.0 };
+
+			BestDistanceSqr = DistanceSqr;
+			BestSegment = Index;
+			BestDistance = FMath::Lerp(SampleDistances[Index], SampleDistances[Index + 1], static_cast<float>(Alpha));
+		}
+	}
+
+	OutDistanceSqr = BestDistanceSqr;
+	OutSegment = BestSegment;
+
+	return BestDistance;
+}
+
+FVector UViewMode_Spline::GetLocationAtDistance(float Distance) const
+{
+	const auto NumSamples{ SampleLocations.Num() };
+
+	if (bClosedLoop && (SplineLength > 0.0f))
+	{
+		Distance = FMath::Fmod(Distance, SplineLength);
+		Distance = (Distance < 0.0f) ? (Distance + SplineLength) : Distance;
+	}
+	else
+	{
+		Distance = FMath::Clamp(Distance, 0.0f, SplineLength);
+	}
+
+	// Samples are evenly spaced so the segment can be found directly
+
+	const auto Step{ SplineLength / (NumSamples - 1) };
+	const auto Position{ (Step > 0.0f) ? (Distance / Step) : 0.0f };
+	const auto Index{ FMath::Clamp(FMath::FloorToInt32(Position), 0, NumSamples - 2) };
+
+	return FMath::Lerp(SampleLocations[Index], SampleLocations[Index + 1], FMath::Clamp(Position - Index, 0.0f, 1.0f));
+}
@@ -0,0 +1,135 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewMode.h"
+
+#include "ViewMode_Spline.generated.h"
+
+class USplineComponent;
+
+
+/**
+ * ViewMode base class for a camera that moves along a spline (e.g. dolly, rail or scripted corridor)
+ * driven by the progress of the target projected onto the spline
+ * 
+ * Note:
+ *	The spline is sampled at equal arc-length intervals when the ViewMode is activated.
+ *	Every frame the closest point is searched only in a small window of samples around the previous result,
+ *	so no closest-point query is made on the spline itself.
+ *	The whole table is only searched again when the target is too far from the result of the window.
+ */
+UCLASS(Abstract, Blueprintable)
+class GVEXT_API UViewMode_Spline : public UViewMode
+{
+	GENERATED_BODY()
+public:
+	UViewMode_Spline(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	//
+	// Tag of the actor that owns the spline when the target does not provide one through IViewAssistInterface
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline")
+	FName SplineActorTag{ NAME_None };
+
+	//
+	// Distance along the spline between two samples of the lookup table
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline", meta = (ClampMin = "1.0", Units = "cm"))
+	float SampleSpacing{ 50.0f };
+
+	//
+	// Number of samples searched on each side of the previous closest sample
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline", meta = (ClampMin = "1"))
+	int32 SearchWindow{ 8 };
+
+	//
+	// If the closest point found in the window is farther than this from the target, the whole table is searched.
+	// This recovers the progress when the target teleports or respawns further than the window.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline", meta = (ClampMin = "0.0", Units = "cm"))
+	float FullSearchDistance{ 300.0f };
+
+	//
+	// Distance along the spline between the progress of the target and the camera (negative to follow behind)
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline", meta = (Units = "cm"))
+	float ProgressOffset{ -300.0f };
+
+	//
+	// If true, the camera looks at the pivot of the target. Otherwise it looks along the spline.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline")
+	bool bLookAtTarget{ true };
+
+	//
+	// Speed at which the camera follows the progress of the target. 0 follows immediately.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Spline", meta = (ClampMin = "0.0"))
+	float ProgressInterpSpeed{ 0.0f };
+
+protected:
+	TWeakObjectPtr<const USplineComponent> Spline;
+
+	//
+	// Samples of the spline in its local space at equal arc-length intervals
+	//
+	TArray<FVector> SampleLocations;
+
+	//
+	// Distance along the spline of each sample
+	//
+	TArray<float> SampleDistances;
+
+	float SplineLength{ 0.0f };
+	bool bClosedLoop{ false };
+
+	//
+	// If true, no spline was found and the search is not repeated on warm-up until the next activation
+	//
+	bool bSplineLookupFailed{ false };
+
+	int32 LastClosestSample{ INDEX_NONE };
+	float CurrentCameraDistance{ 0.0f };
+
+public:
+	virtual void ResetViewMode() override;
+
+protected:
+	virtual void PreActivateMode() override;
+	virtual void PreWarmUpView() override;
+	virtual void UpdateView(float DeltaTime) override;
+
+	/**
+	 * Find the spline and rebuild the lookup table if it changed. Returns whether it changed.
+	 */
+	bool RefreshSpline();
+
+	/**
+	 * Returns the spline provided by the target or found by SplineActorTag
+	 */
+	virtual const USplineComponent* FindSpline() const;
+
+	/**
+	 * Sample the spline into the lookup table
+	 */
+	void BuildLookupTable(const USplineComponent& InSpline);
+
+	/**
+	 * Returns the distance along the spline of the point closest to the location (in the local space of the spline)
+	 */
+	float FindClosestDistance(const FVector& LocalLocation);
+
+	/**
+	 * Search the segments in the range (wrapped around closed splines) and returns the distance along the spline of the closest point
+	 */
+	float SearchClosestDistance(const FVector& LocalLocation, int32 FirstSegment, int32 LastSegment, double& OutDistanceSqr, int32& OutSegment) const;
+
+	/**
+	 * Returns the location in the local space of the spline at the distance, interpolated from the lookup table
+	 */
+	FVector GetLocationAtDistance(float Distance) const;
+
+};
@@ -3,9 +3,18 @@
 #include "ViewMode_ThirdPerson.h"
 
 #include "ViewAssistInterface.h"
-
+#include "ViewerComponent.h"
+#include "Collision/ViewCollisionFieldSubsystem.h"
+#include "Collision/ViewOccluderFadeSubsystem.h"
+#include "Mode/ViewModeEvaluation.h"
+#include "GVExtScalability.h"
+#include "GVExtLogs.h"
+
+#include "Components/PrimitiveComponent.h"
 #include "Curves/CurveVector.h"
 #include "Engine/Canvas.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
 #include "GameFramework/CameraBlockingVolume.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/Character.h"
@@ -24,6 +33,64 @@ UViewMode_ThirdPerson::UViewMode_ThirdPerson(const FObjectInitializer& ObjectIni
 	PenetrationAvoidanceFeelers.Add(FPenetrationAvoidanceFeeler(FRotator(+20.0f, +00.0f, 0.0f), 1.00f, 1.00f, 00.f, 4));
 	PenetrationAvoidanceFeelers.Add(FPenetrationAvoidanceFeeler(FRotator(-20.0f, +00.0f, 0.0f), 0.50f, 0.50f, 00.f, 4));
 
+	FadeObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldStatic));
+	FadeObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldDynamic));
+}
+
+
+#if WITH_EDITOR
+void UViewMode_ThirdPerson::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Rebuild the feeler directions on next use
+
+	FeelerLocalDirections.Reset();
+}
+#endif
+
+
+void UViewMode_ThirdPerson::PreActivateMode()
+{
+	Super::PreActivateMode();
+
+#if !UE_BUILD_SHIPPING
+	ValidateFeelerConfig();
+#endif
+}
+
+void UViewMode_ThirdPerson::PreDeactivateMode()
+{
+	Super::PreDeactivateMode();
+
+	// Occluders are only faded while this ViewMode is the one being blended in or active
+
+	RestoreFadedOccluders();
+}
+
+void UViewMode_ThirdPerson::PostDeactivateMode()
+{
+	Super::PostDeactivateMode();
+
+	RestoreFadedOccluders();
+}
+
+
+void UViewMode_ThirdPerson::ResetViewMode()
+{
+	Super::ResetViewMode();
+
+	RestoreFadedOccluders();
+
+	AimLineToDesiredPosBlockedPct = 0.0f;
+
+	FeelerFramesUntilNextTrace.Reset();
+	FeelerAsyncTraceHandles.Reset();
+
+	CrouchOffsetBlendPct = 1.0f;
+	InitialCrouchOffset = FVector::ZeroVector;
+	TargetCrouchOffset = FVector::ZeroVector;
+	CurrentCrouchOffset = FVector::ZeroVector;
 }
 
 
@@ -46,9 +113,16 @@ void UViewMode_ThirdPerson::UpdateView(float DeltaTime)
 
 	auto TargetOffset{ FVector(0.0f) };
 
-	TargetOffset.X = TargetOffsetX.GetRichCurveConst()->Eval(PivotRotation.Pitch);
-	TargetOffset.Y = TargetOffsetY.GetRichCurveConst()->Eval(PivotRotation.Pitch);
-	TargetOffset.Z = TargetOffsetZ.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+	if (GetQualityLevel() >= EViewQualityLevel::Low)
+	{
+		TargetOffset = EvalTargetOffsetFromTable(PivotRotation.Pitch);
+	}
+	else
+	{
+		TargetOffset.X = TargetOffsetX.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+		TargetOffset.Y = TargetOffsetY.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+		TargetOffset.Z = TargetOffsetZ.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+	}
 
 	View.Location = PivotLocation + PivotRotation.RotateVector(TargetOffset);
 
@@ -57,6 +131,114 @@ void UViewMode_ThirdPerson::UpdateView(float DeltaTime)
 	UpdatePreventPenetration(DeltaTime);
 }
 
+void UViewMode_ThirdPerson::EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const
+{
+	Super::EvaluateView(Input, OutView);
+
+	const auto PivotLocation{ Input.PivotLocation + FVector(0.0f, 0.0f, Input.CrouchOffset) };
+	const auto& PivotRotation{ OutView.Rotation };
+
+	// Evaluated from the curves regardless of the quality level to match the most accurate client view
+
+	auto TargetOffset{ FVector(0.0f) };
+	TargetOffset.X = TargetOffsetX.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+	TargetOffset.Y = TargetOffsetY.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+	TargetOffset.Z = TargetOffsetZ.GetRichCurveConst()->Eval(PivotRotation.Pitch);
+
+	OutView.Location = PivotLocation + PivotRotation.RotateVector(TargetOffset);
+}
+
+void UViewMode_ThirdPerson::EvaluatePenetration(const FViewModeEvaluationInput& Input, const UWorld& World, FViewModeInfo& InOutView) const
+{
+	if (!bPreventPenetration || (CollisionResponse == EViewModeCollisionResponse::FadeOccluders))
+	{
+		return;
+	}
+
+	// Only the main ray is swept and the camera snaps to the hit as the blocked distance of a settled view
+
+	const auto& Feelers{ GetFeelerConfig().PenetrationAvoidanceFeelers };
+	const auto PushInDistance{ (Feelers.Num() > 0 ? Feelers[0].Extent : 0.0f) + CollisionPushOutDistance };
+
+	auto SafeLoc{ Input.PivotLocation + FVector(0.0f, 0.0f, Input.CrouchOffset) };
+
+	// Pick the safe location on the capsule closest to the aim line, as UpdatePreventPenetration does
+
+	if (Input.PenetrationTargetHalfHeight > 0.0f)
+	{
+		auto ClosestPointOnLineToCapsuleCenter{ FVector::ZeroVector };
+		FMath::PointDistToLine(Input.PenetrationTargetLocation, InOutView.Rotation.Vector(), InOutView.Location, ClosestPointOnLineToCapsuleCenter);
+
+		const auto Radius{ FMath::Min(Input.PenetrationTargetRadius, Input.PenetrationTargetHalfHeight) };
+		const auto AxisHalfLength{ Input.PenetrationTargetHalfHeight - Radius };
+		const auto ClosestPointOnAxis{ FMath::ClosestPointOnSegment(ClosestPointOnLineToCapsuleCenter,
+			Input.PenetrationTargetLocation - FVector(0.0f, 0.0f, AxisHalfLength), Input.PenetrationTargetLocation + FVector(0.0f, 0.0f, AxisHalfLength)) };
+
+		const auto AxisOffset{ ClosestPointOnLineToCapsuleCenter - ClosestPointOnAxis };
+
+		SafeLoc = (AxisOffset.SizeSquared() > FMath::Square(Radius)) ? (ClosestPointOnAxis + AxisOffset.GetSafeNormal() * Radius) : ClosestPointOnLineToCapsuleCenter;
+
+		// Push back inside capsule to avoid initial penetration when doing line checks.
+
+		if (Feelers.Num() > 0)
+		{
+			SafeLoc += (SafeLoc - ClosestPointOnLineToCapsuleCenter).GetSafeNormal() * PushInDistance;
+		}
+	}
+
+	const auto BaseRay{ InOutView.Location - SafeLoc };
+	const auto BaseRayLength{ BaseRay.Size() };
+
+	if (BaseRayLength <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const auto SphereParams{ FCollisionQueryParams(SCENE_QUERY_STAT(CameraPenEvaluation), false, Input.IgnoredActor) };
+	const auto SphereShape{ FCollisionShape::MakeSphere((Feelers.Num() > 0) ? Feelers[0].Extent : 0.0f) };
+
+	FHitResult Hit;
+	if (World.SweepSingleByChannel(Hit, SafeLoc, InOutView.Location, FQuat::Identity, ECC_Camera, SphereShape, SphereParams))
+	{
+		// Apply the weight of the main feeler to the blocked distance
+
+		const auto Weight{ (Feelers.Num() > 0) ? (Cast<APawn>(Hit.GetActor()) ? Feelers[0].PawnWeight : Feelers[0].WorldWeight) : 1.0f };
+
+		auto DistBlockedPct{ FMath::Clamp<float>(((Hit.Location - SafeLoc).Size() - CollisionPushOutDistance) / BaseRayLength, 0.0f, 1.0f) };
+		DistBlockedPct += (1.0f - DistBlockedPct) * (1.0f - Weight);
+
+		InOutView.Location = SafeLoc + BaseRay * DistBlockedPct;
+	}
+}
+
+FVector UViewMode_ThirdPerson::EvalTargetOffsetFromTable(float Pitch)
+{
+	static constexpr auto TableMinPitch{ -90.0f };
+	static constexpr auto TableMaxPitch{ 90.0f };
+	static constexpr auto TableNum{ 181 };
+
+	// The curves can only be edited on the class defaults, so the table is built once on first use
+
+	if (TargetOffsetTable.Num() != TableNum)
+	{
+		TargetOffsetTable.SetNumUninitialized(TableNum);
+
+		for (auto Index{ 0 }; Index < TableNum; ++Index)
+		{
+			const auto TablePitch{ FMath::Lerp(TableMinPitch, TableMaxPitch, Index / static_cast<float>(TableNum - 1)) };
+
+			TargetOffsetTable[Index].X = TargetOffsetX.GetRichCurveConst()->Eval(TablePitch);
+			TargetOffsetTable[Index].Y = TargetOffsetY.GetRichCurveConst()->Eval(TablePitch);
+			TargetOffsetTable[Index].Z = TargetOffsetZ.GetRichCurveConst()->Eval(TablePitch);
+		}
+	}
+
+	const auto TablePosition{ (FMath::Clamp(Pitch, TableMinPitch, TableMaxPitch) - TableMinPitch) * ((TableNum - 1) / (TableMaxPitch - TableMinPitch)) };
+	const auto Index{ FMath::Min(FMath::FloorToInt32(TablePosition), TableNum - 2) };
+
+	return FMath::Lerp(TargetOffsetTable[Index], TargetOffsetTable[Index + 1], TablePosition - Index);
+}
+
 void UViewMode_ThirdPerson::UpdateForTarget(float DeltaTime)
 {
 	if (const auto* TargetCharacter{ GetTargetPawn<ACharacter>() })
@@ -89,7 +271,12 @@ void UViewMode_ThirdPerson::UpdatePreventPenetration(float DeltaTime)
 	auto* TargetPawnAssist{ Cast<IViewAssistInterface>(TargetPawn) };
 
 	auto OptionalPPTarget{ TargetPawnAssist ? TargetPawnAssist->GetCameraPreventPenetrationTarget() : TOptional<AActor*>() };
-	auto* PPActor{ OptionalPPTarget.IsSet() ? OptionalPPTarget.GetValue() : TargetPawn };
+	auto* PPActor{ OptionalPPTarget.IsSet() ? OptionalPPTarget.GetValue() : GetTarget() };
+
+	if (!PPActor)
+	{
+		return;
+	}
 
 	auto* PPActorAssist{ OptionalPPTarget.IsSet() ? Cast<IViewAssistInterface>(PPActor) : nullptr };
 
@@ -106,7 +293,8 @@ void UViewMode_ThirdPerson::UpdatePreventPenetration(float DeltaTime)
 
 		// Adjust Safe distance height to be same as aim line, but within capsule.
 
-		const auto PushInDistance{ PenetrationAvoidanceFeelers[0].Extent + CollisionPushOutDistance };
+		const auto& Feelers{ GetFeelerConfig().PenetrationAvoidanceFeelers };
+		const auto PushInDistance{ (Feelers.Num() > 0 ? Feelers[0].Extent : 0.0f) + CollisionPushOutDistance };
 		const auto MaxHalfHeight{ PPActor->GetSimpleCollisionHalfHeight() - PushInDistance };
 
 		SafeLocation.Z = FMath::Clamp(ClosestPointOnLineToCapsuleCenter.Z, SafeLocation.Z - MaxHalfHeight, SafeLocation.Z + MaxHalfHeight);
@@ -116,19 +304,60 @@ void UViewMode_ThirdPerson::UpdatePreventPenetration(float DeltaTime)
 
 		// Push back inside capsule to avoid initial penetration when doing line checks.
 
-		if (PenetrationAvoidanceFeelers.Num() > 0)
+		if (Feelers.Num() > 0)
 		{
 			SafeLocation += (SafeLocation - ClosestPointOnLineToCapsuleCenter).GetSafeNormal() * PushInDistance;
 		}
 
+		// Keep the camera distance and fade the occluders instead of pulling the camera in
+
+		if (CollisionResponse == EViewModeCollisionResponse::FadeOccluders)
+		{
+			if (CanApplySideEffects())
+			{
+				UpdateOccluderFade(*PPActor, SafeLocation, View.Location);
+			}
+
+			return;
+		}
+
 		// Then aim line to desired camera position
 
-		const bool bSingleRayPenetrationCheck{ !bDoPredictiveAvoidance };
-		PreventCameraPenetration(*PPActor, SafeLocation, View.Location, DeltaTime, AimLineToDesiredPosBlockedPct, bSingleRayPenetrationCheck);
+		const auto QualityLevel{ GetQualityLevel() };
+
+		// The traces may not be updated every frame, in which case the last result is reused in between
+
+		auto PenetrationUpdateInterval{ GVExtScalability::GetPenetrationUpdateInterval() };
+
+		if (QualityLevel >= EViewQualityLevel::Minimal)
+		{
+			PenetrationUpdateInterval = FMath::Max(PenetrationUpdateInterval, 2);
+		}
+
+		// Offset by the instance so that the viewers do not all trace in the same frame
+
+		if (((GFrameCounter + GetUniqueID()) % PenetrationUpdateInterval) != 0)
+		{
+			if (AimLineToDesiredPosBlockedPct < (1.f - ZERO_ANIMWEIGHT_THRESH))
+			{
+				View.Location = SafeLocation + (View.Location - SafeLocation) * AimLineToDesiredPosBlockedPct;
+			}
+		}
+		else
+		{
+			const bool bSingleRayPenetrationCheck
+			{
+				!bDoPredictiveAvoidance || 
+				!GVExtScalability::IsPredictiveAvoidanceAllowed() || 
+				(QualityLevel >= EViewQualityLevel::Reduced)
+			};
+
+			PreventCameraPenetration(*PPActor, SafeLocation, View.Location, DeltaTime, AimLineToDesiredPosBlockedPct, bSingleRayPenetrationCheck);
+		}
 
 		auto AssistArray{ TArray<IViewAssistInterface*>({ TargetControllerAssist, TargetPawnAssist, PPActorAssist }) };
 
-		if (AimLineToDesiredPosBlockedPct < ReportPenetrationPercent)
+		if (CanApplySideEffects() && (AimLineToDesiredPosBlockedPct < ReportPenetrationPercent))
 		{
 			for (const auto& Assist : AssistArray)
 			{
@@ -154,9 +383,24 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 	FVector BaseRayLocalUp, BaseRayLocalFwd, BaseRayLocalRight;
 	BaseRayMatrix.GetScaledAxes(BaseRayLocalFwd, BaseRayLocalRight, BaseRayLocalUp);
 
+	// The feeler configuration is shared from the class default object, only the trace timing belongs to this instance
+
+	const auto& Feelers{ GetFeelerConfig().PenetrationAvoidanceFeelers };
+	const auto FeelerDirections{ GetFeelerLocalDirections() };
+
+	if (FeelerFramesUntilNextTrace.Num() != Feelers.Num())
+	{
+		FeelerFramesUntilNextTrace.SetNumZeroed(Feelers.Num());
+	}
+
 	auto DistBlockedPctThisFrame{ 1.0f };
+	auto* ClosestHitComponent{ static_cast<UPrimitiveComponent*>(nullptr) };
+	auto NumSweeps{ 0 };
+	auto NumSweepHits{ 0 };
 
-	const auto NumRaysToShoot{ bSingleRayOnly ? FMath::Min(1, PenetrationAvoidanceFeelers.Num()) : PenetrationAvoidanceFeelers.Num() };
+	const auto MaxFeelers{ GVExtScalability::GetMaxFeelers() };
+	const auto NumFeelers{ (MaxFeelers >= 0) ? FMath::Min(FMath::Max(MaxFeelers, 1), Feelers.Num()) : Feelers.Num() };
+	const auto NumRaysToShoot{ bSingleRayOnly ? FMath::Min(1, NumFeelers) : NumFeelers };
 	auto SphereParams{ FCollisionQueryParams(SCENE_QUERY_STAT(CameraPen), false, nullptr/*PlayerCamera*/) };
 
 	SphereParams.AddIgnoredActor(&ViewTarget);
@@ -164,17 +408,96 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 	auto SphereShape{ FCollisionShape::MakeSphere(0.f) };
 	auto* World{ GetWorld() };
 
+	// Lengthen the interval of the feelers at low quality
+
+	const auto TraceIntervalScale{ GVExtScalability::GetTraceIntervalScale() * ((GetQualityLevel() >= EViewQualityLevel::Low) ? 2.0f : 1.0f) };
+
+	// Use the distance field for the static geometry if it is available
+
+	const auto* CollisionField
+	{
+		(CollisionBackend == EViewModeCollisionBackend::DistanceField) ? World->GetSubsystem<UViewCollisionFieldSubsystem>() : nullptr
+	};
+
+	if (CollisionField && !CollisionField->HasField())
+	{
+		CollisionField = nullptr;
+	}
+
+	// calc ray targets of all feelers in a single branch-free pass from the basis of the main ray.
+	// ray = Length * (Dir.X * Fwd + Dir.Y * Right + Dir.Z * Up)
+
+	const auto BaseRayLength{ BaseRay.Size() };
+	const auto ScaledFwd{ BaseRayLocalFwd * BaseRayLength };
+	const auto ScaledRight{ BaseRayLocalRight * BaseRayLength };
+	const auto ScaledUp{ BaseRayLocalUp * BaseRayLength };
+
+	const auto SafeLocRegister{ VectorLoadFloat3_W0(&SafeLoc.X) };
+	const auto FwdRegister{ VectorLoadFloat3_W0(&ScaledFwd.X) };
+	const auto RightRegister{ VectorLoadFloat3_W0(&ScaledRight.X) };
+	const auto UpRegister{ VectorLoadFloat3_W0(&ScaledUp.X) };
+
+	TArray<FVector, TInlineAllocator<8>> RayTargets;
+	RayTargets.SetNumUninitialized(NumRaysToShoot);
+
+	for (auto RayIdx{ 0 }; RayIdx < NumRaysToShoot; ++RayIdx)
+	{
+		const auto& Direction{ FeelerDirections[RayIdx] };
+
+		auto RayTarget{ VectorMultiplyAdd(FwdRegister, VectorSetFloat1(Direction.X), SafeLocRegister) };
+		RayTarget = VectorMultiplyAdd(RightRegister, VectorSetFloat1(Direction.Y), RayTarget);
+		RayTarget = VectorMultiplyAdd(UpRegister, VectorSetFloat1(Direction.Z), RayTarget);
+
+		VectorStoreFloat3(RayTarget, &RayTargets[RayIdx].X);
+	}
+
+	auto FeelerBounds{ FBox(SafeLoc, SafeLoc) };
+	auto MaxFeelerExtent{ 0.0f };
+	auto NumFeelersToTrace{ 0 };
+
 	for (auto RayIdx{ 0 }; RayIdx < NumRaysToShoot; ++RayIdx)
 	{
-		auto& Feeler{ PenetrationAvoidanceFeelers[RayIdx] };
-		if (Feeler.FramesUntilNextTrace <= 0)
+		if (FeelerFramesUntilNextTrace[RayIdx] == 0)
 		{
-			// calc ray target
+			FeelerBounds += RayTargets[RayIdx];
+			MaxFeelerExtent = FMath::Max(MaxFeelerExtent, Feelers[RayIdx].Extent);
+			++NumFeelersToTrace;
+		}
+	}
+
+	// Broadphase: a single overlap covering the whole feeler fan.
+	// If nothing blocking is found, no feeler can hit and the individual sweeps are skipped.
+	// Otherwise the feelers only sweep against the primitives found here.
+
+	const auto bUseBroadphase{ bUseFeelerBroadphase && !CollisionField && (NumFeelersToTrace > 1) };
+
+	TArray<UPrimitiveComponent*, TInlineAllocator<8>> BroadphasePrimitives;
+
+	if (bUseBroadphase)
+	{
+		FeelerBounds = FeelerBounds.ExpandBy(MaxFeelerExtent);
+
+		TArray<FOverlapResult> Overlaps;
+		World->OverlapMultiByChannel(Overlaps, FeelerBounds.GetCenter(), FQuat::Identity, ECC_Camera, FCollisionShape::MakeBox(FeelerBounds.GetExtent()), SphereParams);
+
+		for (const auto& Overlap : Overlaps)
+		{
+			auto* Primitive{ Overlap.GetComponent() };
+			if (Overlap.bBlockingHit && Primitive)
+			{
+				BroadphasePrimitives.AddUnique(Primitive);
+			}
+		}
+	}
 
-			auto RotatedRay{ BaseRay.RotateAngleAxis(Feeler.AdjustmentRot.Yaw, BaseRayLocalUp) };
-			RotatedRay = RotatedRay.RotateAngleAxis(Feeler.AdjustmentRot.Pitch, BaseRayLocalRight);
+	for (auto RayIdx{ 0 }; RayIdx < NumRaysToShoot; ++RayIdx)
+	{
+		const auto& Feeler{ Feelers[RayIdx] };
+		auto& FramesUntilNextTrace{ FeelerFramesUntilNextTrace[RayIdx] };
 
-			auto RayTarget{ SafeLoc + RotatedRay };
+		if (FramesUntilNextTrace == 0)
+		{
+			const auto& RayTarget{ RayTargets[RayIdx] };
 
 			// cast for world and pawn hits separately.  this is so we can safely ignore the 
 			// camera's target pawn
@@ -188,19 +511,61 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 			// MT-> passing camera as actor so that camerablockingvolumes know when it's the camera doing traces
 
 			FHitResult Hit;
-			const auto bHit{ World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel, SphereShape, SphereParams) };
+			auto bHit{ false };
+			auto bUsedAsyncResult{ false };
 
-			Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
+			// Use the result of the async sweep submitted at the end of the previous update if available.
+			// It was swept along the ray of the previous frame, which is only tolerated by the predictive feelers.
+
+			if (FeelerAsyncTraceHandles.IsValidIndex(RayIdx) && FeelerAsyncTraceHandles[RayIdx].IsValid())
+			{
+				FTraceDatum TraceDatum;
+				if (World->QueryTraceData(FeelerAsyncTraceHandles[RayIdx], TraceDatum))
+				{
+					if (const auto* BlockingHit{ FHitResult::GetFirstBlockingHit(TraceDatum.OutHits) })
+					{
+						Hit = *BlockingHit;
+						bHit = true;
+					}
+
+					bUsedAsyncResult = true;
+				}
+
+				FeelerAsyncTraceHandles[RayIdx] = FTraceHandle();
+			}
+
+			if (bUsedAsyncResult)
+			{
+				// The hit of the previous frame is used as is
+			}
+			else if (CollisionField)
+			{
+				bHit = TraceFeelerWithCollisionField(Hit, *CollisionField, SafeLoc, RayTarget, SphereShape, SphereParams);
+			}
+			else if (bUseBroadphase)
+			{
+				bHit = SweepFeelerAgainstPrimitives(Hit, SafeLoc, RayTarget, SphereShape, SphereParams, BroadphasePrimitives);
+			}
+			else
+			{
+				bHit = World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel, SphereShape, SphereParams);
+			}
+
+			FramesUntilNextTrace = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Feeler.TraceInterval * TraceIntervalScale), 0, MAX_uint8));
+
+			++NumSweeps;
 
 			const auto* HitActor{ Hit.GetActor() };
 
-			if (bHit && HitActor)
+			// Hits on the distance field have no actor and are treated as world hits
+
+			if (bHit && (HitActor || CollisionField))
 			{
 				auto bIgnoreHit{ false };
 
 				// Ignore CameraBlockingVolume hits that occur in front of the ViewTarget.
 
-				if (!bIgnoreHit && HitActor->IsA<ACameraBlockingVolume>())
+				if (!bIgnoreHit && HitActor && HitActor->IsA<ACameraBlockingVolume>())
 				{
 					const auto ViewTargetForwardXY{ ViewTarget.GetActorForwardVector().GetSafeNormal2D() };
 					const auto ViewTargetLocation{ ViewTarget.GetActorLocation() };
@@ -215,11 +580,14 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 						// Ignore this CameraBlockingVolume on the remaining sweeps.
 
 						SphereParams.AddIgnoredActor(HitActor);
+						BroadphasePrimitives.RemoveAll([HitActor](const UPrimitiveComponent* Primitive) { return Primitive->GetOwner() == HitActor; });
 					}
 				}
 				
 				if (!bIgnoreHit)
 				{
+					++NumSweepHits;
+
 					const auto Weight{ Cast<APawn>(Hit.GetActor()) ? Feeler.PawnWeight : Feeler.WorldWeight };
 					auto NewBlockPct{ Hit.Time };
 					NewBlockPct += (1.f - NewBlockPct) * (1.f - Weight);
@@ -227,11 +595,16 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 					// Recompute blocked pct taking into account pushout distance.
 
 					NewBlockPct = ((Hit.Location - SafeLoc).Size() - CollisionPushOutDistance) / (RayTarget - SafeLoc).Size();
-					DistBlockedPctThisFrame = FMath::Min(NewBlockPct, DistBlockedPctThisFrame);
+
+					if (NewBlockPct < DistBlockedPctThisFrame)
+					{
+						DistBlockedPctThisFrame = NewBlockPct;
+						ClosestHitComponent = Hit.GetComponent();
+					}
 
 					// This feeler got a hit, so do another trace next frame
 
-					Feeler.FramesUntilNextTrace = 0;
+					FramesUntilNextTrace = 0;
 				}
 			}
 
@@ -249,10 +622,18 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 		}
 		else
 		{
-			--Feeler.FramesUntilNextTrace;
+			--FramesUntilNextTrace;
 		}
 	}
 
+	// Sweep the feelers that are due in the next frame along the current ray, with the same ignored actors as above.
+	// A ViewMode warming up is not updated in the next frame, so its results would never be read.
+
+	if (!bSingleRayOnly && !IsWarmingUp())
+	{
+		SubmitAsyncFeelerSweeps(SafeLoc, RayTargets, SphereParams);
+	}
+
 	if (bResetInterpolation)
 	{
 		DistBlockedPct = DistBlockedPctThisFrame;
@@ -292,12 +673,273 @@ void UViewMode_ThirdPerson::PreventCameraPenetration(class AActor const& ViewTar
 	}
 
 	DistBlockedPct = FMath::Clamp<float>(DistBlockedPct, 0.f, 1.f);
+
+	// Share the result with other systems only while this ViewMode is the top of the Stack
+
+	const auto bIsTopOfStack{ (ActivationState == EViewModeActivationState::PreActivate) || (ActivationState == EViewModeActivationState::Activated) };
+
+	if (auto* Viewer{ bIsTopOfStack ? GetViewerComponent() : nullptr })
+	{
+		FViewFeelerTraceResult Result;
+		Result.BlockedPct = DistBlockedPctThisFrame;
+		Result.HitComponent = ClosestHitComponent;
+		Result.NumSweeps = NumSweeps;
+		Result.NumSweepHits = NumSweepHits;
+		Result.SafeLocation = SafeLoc;
+		Result.DesiredLocation = CameraLoc;
+
+		Viewer->PublishFeelerTraceResult(Result);
+	}
+
 	if (DistBlockedPct < (1.f - ZERO_ANIMWEIGHT_THRESH))
 	{
 		CameraLoc = SafeLoc + (CameraLoc - SafeLoc) * DistBlockedPct;
 	}
 }
 
+void UViewMode_ThirdPerson::ValidateFeelerConfig() const
+{
+	const auto& Config{ GetFeelerConfig() };
+
+	if ((&Config != this) && (Config.PenetrationAvoidanceFeelers != PenetrationAvoidanceFeelers))
+	{
+		UE_LOG(LogGVE, Warning, TEXT("[%s] PenetrationAvoidanceFeelers differs from the class default object and is ignored. Change the class default object instead."), *GetPathNameSafe(this));
+	}
+}
+
+const UViewMode_ThirdPerson& UViewMode_ThirdPerson::GetFeelerConfig() const
+{
+	const auto* ClassDefault{ GetClass()->GetDefaultObject<UViewMode_ThirdPerson>() };
+
+	return ClassDefault ? *ClassDefault : *this;
+}
+
+TConstArrayView<FVector> UViewMode_ThirdPerson::GetFeelerLocalDirections() const
+{
+	const auto& Config{ GetFeelerConfig() };
+	const auto& Feelers{ Config.PenetrationAvoidanceFeelers };
+
+	// Built once for each class and shared by all instances
+
+	if (Config.FeelerLocalDirections.Num() != Feelers.Num())
+	{
+		Config.FeelerLocalDirections.Reset(Feelers.Num());
+
+		for (const auto& Feeler : Feelers)
+		{
+			Config.FeelerLocalDirections.Add(Feeler.GetLocalDirection());
+		}
+	}
+
+	return Config.FeelerLocalDirections;
+}
+
+void UViewMode_ThirdPerson::SubmitAsyncFeelerSweeps(const FVector& SafeLoc, TConstArrayView<FVector> RayTargets, const FCollisionQueryParams& Params)
+{
+	auto* World{ GetWorld() };
+
+	if (!World || !GVExtScalability::IsAsyncSweepEnabled())
+	{
+		return;
+	}
+
+	// Only the predictive feelers tolerate one frame of latency
+
+	if ((CollisionResponse != EViewModeCollisionResponse::PullIn) || (CollisionBackend != EViewModeCollisionBackend::PhysicsScene))
+	{
+		return;
+	}
+
+	if (!bDoPredictiveAvoidance || !GVExtScalability::IsPredictiveAvoidanceAllowed() || (GetQualityLevel() >= EViewQualityLevel::Reduced))
+	{
+		return;
+	}
+
+	const auto& Feelers{ GetFeelerConfig().PenetrationAvoidanceFeelers };
+
+	FeelerAsyncTraceHandles.SetNum(Feelers.Num());
+
+	for (auto RayIdx{ 1 }; RayIdx < RayTargets.Num(); ++RayIdx)
+	{
+		// Submit only for the feelers that will be traced in the next frame
+
+		if (FeelerFramesUntilNextTrace[RayIdx] != 0)
+		{
+			continue;
+		}
+
+		FeelerAsyncTraceHandles[RayIdx] = World->AsyncSweepByChannel(
+			EAsyncTraceType::Single, SafeLoc, RayTargets[RayIdx], FQuat::Identity, ECC_Camera, FCollisionShape::MakeSphere(Feelers[RayIdx].Extent), Params);
+	}
+}
+
+bool UViewMode_ThirdPerson::TraceFeelerWithCollisionField(FHitResult& OutHit, const UViewCollisionFieldSubsystem& CollisionField, const FVector& Start, const FVector& End, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const
+{
+	// The static geometry of the levels that are not baked yet is only in the physics scene
+
+	if (!CollisionField.IsSegmentBaked(Start, End, Shape.GetSphereRadius()))
+	{
+		return GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, ECC_Camera, Shape, Params);
+	}
+
+	auto bHit{ false };
+
+	// Static geometry is answered by sphere tracing the distance field
+
+	auto FieldHitTime{ 1.0f };
+	if (CollisionField.SphereTrace(Start, End, Shape.GetSphereRadius(), FieldHitTime))
+	{
+		OutHit = FHitResult(Start, End);
+		OutHit.bBlockingHit = true;
+		OutHit.Time = FieldHitTime;
+		OutHit.Location = FMath::Lerp(Start, End, FieldHitTime);
+		OutHit.ImpactPoint = OutHit.Location;
+
+		bHit = true;
+	}
+
+	// Only movable primitives need a physics scene query
+
+	auto DynamicParams{ Params };
+	DynamicParams.MobilityType = EQueryMobilityType::Dynamic;
+
+	FHitResult DynamicHit;
+	if (GetWorld()->SweepSingleByChannel(DynamicHit, Start, End, FQuat::Identity, ECC_Camera, Shape, DynamicParams))
+	{
+		if (!bHit || (DynamicHit.Time < OutHit.Time))
+		{
+			OutHit = DynamicHit;
+			bHit = true;
+		}
+	}
+
+	// CameraBlockingVolumes are not baked, so test the few that the ray may pass through
+
+	TArray<UPrimitiveComponent*, TInlineAllocator<4>> Volumes;
+	CollisionField.GetCameraBlockingVolumes(Start, End, Shape.GetSphereRadius(), Volumes);
+
+	const auto& IgnoredActors{ Params.GetIgnoredActors() };
+	Volumes.RemoveAll([&IgnoredActors](const UPrimitiveComponent* Volume) { return IgnoredActors.Contains(Volume->GetOwner()->GetUniqueID()); });
+
+	FHitResult VolumeHit;
+	if (SweepFeelerAgainstPrimitives(VolumeHit, Start, End, Shape, Params, Volumes))
+	{
+		if (!bHit || (VolumeHit.Time < OutHit.Time))
+		{
+			OutHit = VolumeHit;
+			bHit = true;
+		}
+	}
+
+	return bHit;
+}
+
+bool UViewMode_ThirdPerson::SweepFeelerAgainstPrimitives(FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape, const FCollisionQueryParams& Params, TConstArrayView<UPrimitiveComponent*> Primitives) const
+{
+	auto bHit{ false };
+
+	// Keep the closest hit among the primitives found by the broadphase
+
+	for (auto* Primitive : Primitives)
+	{
+		FHitResult PrimitiveHit;
+		const auto bPrimitiveHit
+		{
+			Shape.GetSphereRadius() > 0.0f
+			? Primitive->SweepComponent(PrimitiveHit, Start, End, FQuat::Identity, Shape, Params.bTraceComplex)
+			: Primitive->LineTraceComponent(PrimitiveHit, Start, End, Params)
+		};
+
+		if (bPrimitiveHit && (!bHit || (PrimitiveHit.Time < OutHit.Time)))
+		{
+			OutHit = PrimitiveHit;
+			bHit = true;
+		}
+	}
+
+	return bHit;
+}
+
+void UViewMode_ThirdPerson::UpdateOccluderFade(const AActor& ViewTarget, const FVector& SafeLoc, const FVector& CameraLoc)
+{
+	// Only the ViewMode being blended in or active fades the occluders.
+
+	if ((ActivationState != EViewModeActivationState::PreActivate) && (ActivationState != EViewModeActivationState::Activated))
+	{
+		return;
+	}
+
+	auto* World{ GetWorld() };
+	const auto CurrentTime{ World->GetTimeSeconds() };
+
+	// Gather all primitives between the safe location and the camera with a single multi sweep.
+	// Object type queries do not stop at the first blocking hit, so everything along the line is returned.
+
+	auto FadeParams{ FCollisionQueryParams(SCENE_QUERY_STAT(CameraFade), false) };
+	FadeParams.AddIgnoredActor(&ViewTarget);
+
+	TArray<FHitResult> Hits;
+	World->SweepMultiByObjectType(Hits, SafeLoc, CameraLoc, FQuat::Identity, FCollisionObjectQueryParams(FadeObjectTypes), FCollisionShape::MakeSphere(FadeSweepRadius), FadeParams);
+
+	// Refresh the occluders that are still hit and fade the new ones
+
+	for (const auto& Hit : Hits)
+	{
+		auto* Primitive{ Hit.GetComponent() };
+		if (!Primitive)
+		{
+			continue;
+		}
+
+		if (auto* LastOccludedTime{ FadedOccluders.Find(Primitive) })
+		{
+			*LastOccludedTime = CurrentTime;
+		}
+		else
+		{
+			FadedOccluders.Add(Primitive, CurrentTime);
+			FadeOccluder(Primitive);
+		}
+	}
+
+	// Restore the occluders that have not been hit for longer than the release delay
+
+	for (auto It{ FadedOccluders.CreateIterator() }; It; ++It)
+	{
+		if (!It->Key.IsValid() || ((CurrentTime - It->Value) > FadeReleaseDelay))
+		{
+			RestoreOccluder(It->Key);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UViewMode_ThirdPerson::FadeOccluder(UPrimitiveComponent* Primitive) const
+{
+	if (auto* FadeSubsystem{ UWorld::GetSubsystem<UViewOccluderFadeSubsystem>(GetWorld()) })
+	{
+		FadeSubsystem->AddFade(Primitive, FadeCustomPrimitiveDataIndex, FadedPrimitiveDataValue);
+	}
+}
+
+void UViewMode_ThirdPerson::RestoreOccluder(const TWeakObjectPtr<UPrimitiveComponent>& Primitive) const
+{
+	if (auto* FadeSubsystem{ UWorld::GetSubsystem<UViewOccluderFadeSubsystem>(GetWorld()) })
+	{
+		FadeSubsystem->RemoveFade(Primitive, FadeCustomPrimitiveDataIndex);
+	}
+}
+
+void UViewMode_ThirdPerson::RestoreFadedOccluders()
+{
+	for (const auto& KVP : FadedOccluders)
+	{
+		RestoreOccluder(KVP.Key);
+	}
+
+	FadedOccluders.Reset();
+}
+
 
 void UViewMode_ThirdPerson::SetTargetCrouchOffset(FVector NewTargetOffset)
 {
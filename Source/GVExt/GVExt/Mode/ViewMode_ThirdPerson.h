@@ -6,10 +6,17 @@
 
 #include "PenetrationAvoidanceFeeler.h"
 
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+
 #include "ViewMode_ThirdPerson.generated.h"
 
 class UCurveVector;
+class UPrimitiveComponent;
+class UViewCollisionFieldSubsystem;
 struct FRuntimeFloatCurve;
+struct FCollisionShape;
+struct FCollisionQueryParams;
 
 
 /**
@@ -56,6 +63,22 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
 	bool bDoPredictiveAvoidance{ true };
 
+	//
+	// If true, a single overlap covering all feelers is done first. 
+	// The feeler sweeps are skipped when it finds nothing and only test the primitives it found otherwise.
+	// Reduces the cost in open areas where most feelers do not hit anything.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
+	bool bUseFeelerBroadphase{ false };
+
+	//
+	// Source of the collision used by the feelers.
+	// DistanceField requires "gvext.CollisionField.Enable" and falls back to PhysicsScene when no field is available
+	// or when the feeler passes through a level that is not baked yet.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
+	EViewModeCollisionBackend CollisionBackend{ EViewModeCollisionBackend::PhysicsScene };
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
 	float CollisionPushOutDistance{ 2.0f };
 
@@ -72,27 +95,145 @@ protected:
 	//             were to rotate towards that direction and primitively collide the camera so that it pulls in before
 	//             impacting the occluder.
 	//
+	// Note:
+	//	Only the values of the class default object are used at runtime.
+	//	A warning is logged on activation if an instance differs from it.
+	//
 	UPROPERTY(EditDefaultsOnly, Category = "Collision")
 	TArray<FPenetrationAvoidanceFeeler> PenetrationAvoidanceFeelers;
 
+	//
+	// Direction of each feeler in the basis of the main ray, built once on the class default object
+	//
+	mutable TArray<FVector> FeelerLocalDirections;
+
+	//
+	// How the camera responds to geometry between the view target and the camera.
+	// PullIn moves the camera in front of the geometry using the feelers.
+	// FadeOccluders keeps the camera distance and fades the occluding primitives with a single sweep.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
+	EViewModeCollisionResponse CollisionResponse{ EViewModeCollisionResponse::PullIn };
+
+	//
+	// Object types of the primitives to be faded
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Collision|Fade", meta = (EditCondition = "CollisionResponse == EViewModeCollisionResponse::FadeOccluders"))
+	TArray<TEnumAsByte<EObjectTypeQuery>> FadeObjectTypes;
+
+	//
+	// Radius of the sweep used to find the occluding primitives
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision|Fade", meta = (EditCondition = "CollisionResponse == EViewModeCollisionResponse::FadeOccluders", ClampMin = "0.0"))
+	float FadeSweepRadius{ 10.0f };
+
+	//
+	// Time that a primitive stays faded after it no longer occludes the camera.
+	// Prevents primitives at the edge of the sweep from flickering in and out.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision|Fade", meta = (EditCondition = "CollisionResponse == EViewModeCollisionResponse::FadeOccluders", ClampMin = "0.0"))
+	float FadeReleaseDelay{ 0.3f };
+
+	//
+	// Index of the custom primitive data that receives the fade value.
+	// The materials of the primitives to be faded are expected to read this value.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Collision|Fade", meta = (EditCondition = "CollisionResponse == EViewModeCollisionResponse::FadeOccluders", ClampMin = "0"))
+	int32 FadeCustomPrimitiveDataIndex{ 0 };
+
+	//
+	// Value written to the custom primitive data while the primitive is faded
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Collision|Fade", meta = (EditCondition = "CollisionResponse == EViewModeCollisionResponse::FadeOccluders"))
+	float FadedPrimitiveDataValue{ 1.0f };
+
+public:
+	virtual void ResetViewMode() override;
+	virtual void EvaluateView(const FViewModeEvaluationInput& Input, FViewModeInfo& OutView) const override;
+	virtual void EvaluatePenetration(const FViewModeEvaluationInput& Input, const UWorld& World, FViewModeInfo& InOutView) const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 protected:
+	virtual void PreActivateMode() override;
+	virtual void PreDeactivateMode() override;
+	virtual void PostDeactivateMode() override;
+
 	virtual void UpdateView(float DeltaTime) override;
 
+	/**
+	 * Submit async sweeps for the predictive feelers that are due in the next frame, along the rays of the current update.
+	 * The results are read by the next update, so they are one frame old when used.
+	 */
+	void SubmitAsyncFeelerSweeps(const FVector& SafeLoc, TConstArrayView<FVector> RayTargets, const FCollisionQueryParams& Params);
+
+	/**
+	 * Evaluate the target offset curves from a lookup table instead of the curves
+	 */
+	FVector EvalTargetOffsetFromTable(float Pitch);
+
 	void UpdateForTarget(float DeltaTime);
 	void UpdatePreventPenetration(float DeltaTime);
 	void PreventCameraPenetration(class AActor const& ViewTarget, FVector const& SafeLoc, FVector& CameraLoc, float const& DeltaTime, float& DistBlockedPct, bool bSingleRayOnly);
+	bool TraceFeelerWithCollisionField(FHitResult& OutHit, const UViewCollisionFieldSubsystem& CollisionField, const FVector& Start, const FVector& End, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const;
+	bool SweepFeelerAgainstPrimitives(FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape, const FCollisionQueryParams& Params, TConstArrayView<UPrimitiveComponent*> Primitives) const;
+	void UpdateOccluderFade(const AActor& ViewTarget, const FVector& SafeLoc, const FVector& CameraLoc);
+
+	/**
+	 * Returns the feeler configuration shared from the class default object
+	 */
+	const UViewMode_ThirdPerson& GetFeelerConfig() const;
+
+	/**
+	 * Warn if the feelers of this instance were changed, since only the class default object is used
+	 */
+	void ValidateFeelerConfig() const;
+
+	/**
+	 * Returns the direction of each feeler in the basis of the main ray
+	 */
+	TConstArrayView<FVector> GetFeelerLocalDirections() const;
 
 
 protected:
 	UPROPERTY(Transient)
 	float AimLineToDesiredPosBlockedPct;
 
+	//
+	// Number of frames until the next trace of each feeler
+	//
+	TArray<uint8, TInlineAllocator<8>> FeelerFramesUntilNextTrace;
+
+	//
+	// Async sweeps of the predictive feelers submitted at the end of the penetration update (gvext.Collision.AsyncSweeps)
+	//
+	TArray<FTraceHandle, TInlineAllocator<8>> FeelerAsyncTraceHandles;
+
+	//
+	// Target offset sampled from the curves every 1 degree of pitch
+	//
+	TArray<FVector> TargetOffsetTable;
+
 	FVector InitialCrouchOffset{ FVector::ZeroVector };
 	FVector TargetCrouchOffset{ FVector::ZeroVector };
 	float CrouchOffsetBlendPct{ 1.0f };
 	FVector CurrentCrouchOffset{ FVector::ZeroVector };
 
+	//
+	// Primitives currently faded by this ViewMode and the last time they occluded the camera
+	// 
+	// Note:
+	//	The custom primitive data is owned by UViewOccluderFadeSubsystem, which restores it when the last ViewMode releases the fade
+	//
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, double> FadedOccluders;
+
 protected:
+	void FadeOccluder(UPrimitiveComponent* Primitive) const;
+	void RestoreOccluder(const TWeakObjectPtr<UPrimitiveComponent>& Primitive) const;
+	void RestoreFadedOccluders();
+
 	void SetTargetCrouchOffset(FVector NewTargetOffset);
 	void UpdateCrouchOffset(float DeltaTime);
 
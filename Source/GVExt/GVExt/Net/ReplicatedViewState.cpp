@@ -0,0 +1,128 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ReplicatedViewState.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedViewState)
+
+
+namespace ReplicatedViewStateQuantization
+{
+	static constexpr float MaxFieldOfView{ 170.0f };
+
+	static uint16 QuantizeSigned(double Value, uint32 NumBits)
+	{
+		const auto MaxValue{ static_cast<int32>((1u << (NumBits - 1)) - 1) };
+		const auto Clamped{ FMath::Clamp(FMath::RoundToInt32(Value), -MaxValue, MaxValue) };
+
+		return static_cast<uint16>(Clamped + MaxValue);
+	}
+
+	static double DequantizeSigned(uint16 Value, uint32 NumBits)
+	{
+		const auto MaxValue{ static_cast<int32>((1u << (NumBits - 1)) - 1) };
+
+		return static_cast<double>(static_cast<int32>(Value) - MaxValue);
+	}
+
+	static uint16 QuantizeAngle(double Angle, uint32 NumBits)
+	{
+		const auto NumSteps{ 1u << NumBits };
+
+		return static_cast<uint16>(FMath::RoundToInt32(FRotator::ClampAxis(Angle) * (NumSteps / 360.0)) & (NumSteps - 1));
+	}
+
+	static double DequantizeAngle(uint16 Value, uint32 NumBits)
+	{
+		return FRotator::NormalizeAxis(Value * (360.0 / (1u << NumBits)));
+	}
+
+	static uint16 QuantizePitch(double Pitch, uint32 NumBits)
+	{
+		const auto MaxValue{ (1u << NumBits) - 1 };
+		const auto Alpha{ (FMath::Clamp(FRotator::NormalizeAxis(Pitch), -90.0, 90.0) + 90.0) / 180.0 };
+
+		return static_cast<uint16>(FMath::RoundToInt32(Alpha * MaxValue));
+	}
+
+	static double DequantizePitch(uint16 Value, uint32 NumBits)
+	{
+		const auto MaxValue{ (1u << NumBits) - 1 };
+
+		return ((Value / static_cast<double>(MaxValue)) * 180.0) - 90.0;
+	}
+}
+
+
+FQuantizedViewState FReplicatedViewState::Quantize() const
+{
+	using namespace ReplicatedViewStateQuantization;
+
+	FQuantizedViewState Result;
+	Result.Location[0] = QuantizeSigned(RelativeLocation.X, FQuantizedViewState::LocationBits);
+	Result.Location[1] = QuantizeSigned(RelativeLocation.Y, FQuantizedViewState::LocationBits);
+	Result.Location[2] = QuantizeSigned(RelativeLocation.Z, FQuantizedViewState::LocationBits);
+	Result.Yaw = QuantizeAngle(Rotation.Yaw, FQuantizedViewState::YawBits);
+	Result.Pitch = QuantizePitch(Rotation.Pitch, FQuantizedViewState::PitchBits);
+	Result.Roll = static_cast<uint8>(QuantizeAngle(Rotation.Roll, FQuantizedViewState::RollBits));
+	Result.FieldOfView = static_cast<uint8>(FMath::RoundToInt32(FMath::Clamp(FieldOfView / MaxFieldOfView, 0.0f, 1.0f) * MAX_uint8));
+	Result.ViewModeId = ViewModeId;
+
+	return Result;
+}
+
+void FReplicatedViewState::Dequantize(const FQuantizedViewState& InQuantized)
+{
+	using namespace ReplicatedViewStateQuantization;
+
+	RelativeLocation.X = DequantizeSigned(InQuantized.Location[0], FQuantizedViewState::LocationBits);
+	RelativeLocation.Y = DequantizeSigned(InQuantized.Location[1], FQuantizedViewState::LocationBits);
+	RelativeLocation.Z = DequantizeSigned(InQuantized.Location[2], FQuantizedViewState::LocationBits);
+	Rotation.Yaw = DequantizeAngle(InQuantized.Yaw, FQuantizedViewState::YawBits);
+	Rotation.Pitch = DequantizePitch(InQuantized.Pitch, FQuantizedViewState::PitchBits);
+	Rotation.Roll = DequantizeAngle(InQuantized.Roll, FQuantizedViewState::RollBits);
+	FieldOfView = (InQuantized.FieldOfView / static_cast<float>(MAX_uint8)) * MaxFieldOfView;
+	ViewModeId = InQuantized.ViewModeId;
+}
+
+bool FReplicatedViewState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Same bit layout as the Iris serializer (FReplicatedViewStateNetSerializer)
+
+	auto Quantized{ Ar.IsSaving() ? Quantize() : FQuantizedViewState() };
+
+	auto SerializeValue
+	{
+		[&Ar](auto& Value, uint32 NumBits)
+		{
+			uint32 Bits{ Value };
+			Ar.SerializeBits(&Bits, NumBits);
+			Value = static_cast<std::remove_reference_t<decltype(Value)>>(Bits);
+		}
+	};
+
+	SerializeValue(Quantized.Location[0], FQuantizedViewState::LocationBits);
+	SerializeValue(Quantized.Location[1], FQuantizedViewState::LocationBits);
+	SerializeValue(Quantized.Location[2], FQuantizedViewState::LocationBits);
+	SerializeValue(Quantized.Yaw, FQuantizedViewState::YawBits);
+	SerializeValue(Quantized.Pitch, FQuantizedViewState::PitchBits);
+
+	auto bHasRoll{ static_cast<uint8>(Quantized.Roll != 0) };
+	SerializeValue(bHasRoll, 1);
+
+	if (bHasRoll)
+	{
+		SerializeValue(Quantized.Roll, FQuantizedViewState::RollBits);
+	}
+
+	SerializeValue(Quantized.FieldOfView, 8);
+	SerializeValue(Quantized.ViewModeId, 8);
+
+	if (Ar.IsLoading())
+	{
+		Dequantize(Quantized);
+	}
+
+	bOutSuccess = !Ar.IsError();
+
+	return true;
+}
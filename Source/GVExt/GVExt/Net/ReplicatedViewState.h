@@ -0,0 +1,103 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "ReplicatedViewState.generated.h"
+
+
+/**
+ * Compact quantized representation of FReplicatedViewState shared by the replication serializers
+ */
+struct FQuantizedViewState
+{
+public:
+	//
+	// Number of bits for each axis of the location relative to the Pawn (1 cm precision, +-40.96 m range)
+	//
+	static constexpr uint32 LocationBits{ 13 };
+
+	static constexpr uint32 YawBits{ 14 };
+	static constexpr uint32 PitchBits{ 13 };
+	static constexpr uint32 RollBits{ 8 };
+
+public:
+	FQuantizedViewState() {}
+
+public:
+	uint16 Location[3]{ 0, 0, 0 };
+	uint16 Yaw{ 0 };
+	uint16 Pitch{ 0 };
+	uint8 Roll{ 0 };
+	uint8 FieldOfView{ 0 };
+	uint8 ViewModeId{ 0 };
+
+public:
+	bool operator==(const FQuantizedViewState& Other) const
+	{
+		return (FMemory::Memcmp(Location, Other.Location, sizeof(Location)) == 0)
+			&& (Yaw == Other.Yaw)
+			&& (Pitch == Other.Pitch)
+			&& (Roll == Other.Roll)
+			&& (FieldOfView == Other.FieldOfView)
+			&& (ViewModeId == Other.ViewModeId);
+	}
+
+	/**
+	 * Returns the number of bits written for this state
+	 */
+	uint32 GetSerializedBits() const { return (LocationBits * 3) + YawBits + PitchBits + 1 + ((Roll != 0) ? RollBits : 0) + 8 + 8; }
+
+};
+
+
+/**
+ * Camera view state of a Viewer replicated to spectators and the server
+ *
+ * Note:
+ *	The location is relative to the Pawn being viewed so that it can be quantized with a small number of bits.
+ *	Roll is only sent when it is not zero.
+ */
+USTRUCT(BlueprintType)
+struct GVEXT_API FReplicatedViewState
+{
+	GENERATED_BODY()
+public:
+	FReplicatedViewState() {}
+
+public:
+	UPROPERTY(BlueprintReadOnly)
+	FVector RelativeLocation{ FVector::ZeroVector };
+
+	UPROPERTY(BlueprintReadOnly)
+	FRotator Rotation{ FRotator::ZeroRotator };
+
+	UPROPERTY(BlueprintReadOnly)
+	float FieldOfView{ 90.0f };
+
+	//
+	// Index + 1 of the ViewMode in the ReplicatedViewModes of the ViewerComponent, 0 if unknown
+	//
+	UPROPERTY(BlueprintReadOnly)
+	uint8 ViewModeId{ 0 };
+
+public:
+	FQuantizedViewState Quantize() const;
+	void Dequantize(const FQuantizedViewState& InQuantized);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FReplicatedViewState& Other) const { return Quantize() == Other.Quantize(); }
+	bool operator!=(const FReplicatedViewState& Other) const { return !(*this == Other); }
+
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedViewState> : public TStructOpsTypeTraitsBase2<FReplicatedViewState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+		WithIdenticalViaEquality = true,
+	};
+};
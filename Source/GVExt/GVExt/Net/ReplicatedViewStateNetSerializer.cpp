@@ -0,0 +1,158 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ReplicatedViewStateNetSerializer.h"
+
+#include "Net/ReplicatedViewState.h"
+
+#if UE_WITH_IRIS
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#endif
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedViewStateNetSerializer)
+
+#if UE_WITH_IRIS
+
+namespace UE::Net
+{
+
+/**
+ * Iris serializer for FReplicatedViewState
+ *
+ * Note:
+ *	The state is quantized once and written with the same bit layout as FReplicatedViewState::NetSerialize.
+ */
+struct FReplicatedViewStateNetSerializer
+{
+public:
+	static const uint32 Version{ 0 };
+
+	typedef FReplicatedViewState SourceType;
+	typedef FQuantizedViewState QuantizedType;
+	typedef FReplicatedViewStateNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+public:
+	static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+	static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+
+	static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+	static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+
+	static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+	static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args);
+
+private:
+	class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+	{
+	public:
+		virtual ~FNetSerializerRegistryDelegates();
+
+	private:
+		virtual void OnPreFreezeNetSerializerRegistry() override;
+	};
+
+	static FReplicatedViewStateNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FReplicatedViewStateNetSerializer);
+
+const FReplicatedViewStateNetSerializer::ConfigType FReplicatedViewStateNetSerializer::DefaultConfig;
+FReplicatedViewStateNetSerializer::FNetSerializerRegistryDelegates FReplicatedViewStateNetSerializer::NetSerializerRegistryDelegates;
+
+
+void FReplicatedViewStateNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	const auto& Value{ *reinterpret_cast<const QuantizedType*>(Args.Source) };
+	auto* Writer{ Context.GetBitStreamWriter() };
+
+	Writer->WriteBits(Value.Location[0], QuantizedType::LocationBits);
+	Writer->WriteBits(Value.Location[1], QuantizedType::LocationBits);
+	Writer->WriteBits(Value.Location[2], QuantizedType::LocationBits);
+	Writer->WriteBits(Value.Yaw, QuantizedType::YawBits);
+	Writer->WriteBits(Value.Pitch, QuantizedType::PitchBits);
+
+	if (Writer->WriteBool(Value.Roll != 0))
+	{
+		Writer->WriteBits(Value.Roll, QuantizedType::RollBits);
+	}
+
+	Writer->WriteBits(Value.FieldOfView, 8);
+	Writer->WriteBits(Value.ViewModeId, 8);
+}
+
+void FReplicatedViewStateNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	auto& Target{ *reinterpret_cast<QuantizedType*>(Args.Target) };
+	auto* Reader{ Context.GetBitStreamReader() };
+
+	Target.Location[0] = static_cast<uint16>(Reader->ReadBits(QuantizedType::LocationBits));
+	Target.Location[1] = static_cast<uint16>(Reader->ReadBits(QuantizedType::LocationBits));
+	Target.Location[2] = static_cast<uint16>(Reader->ReadBits(QuantizedType::LocationBits));
+	Target.Yaw = static_cast<uint16>(Reader->ReadBits(QuantizedType::YawBits));
+	Target.Pitch = static_cast<uint16>(Reader->ReadBits(QuantizedType::PitchBits));
+	Target.Roll = Reader->ReadBool() ? static_cast<uint8>(Reader->ReadBits(QuantizedType::RollBits)) : 0;
+	Target.FieldOfView = static_cast<uint8>(Reader->ReadBits(8));
+	Target.ViewModeId = static_cast<uint8>(Reader->ReadBits(8));
+}
+
+void FReplicatedViewStateNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	const auto& Source{ *reinterpret_cast<const SourceType*>(Args.Source) };
+	auto& Target{ *reinterpret_cast<QuantizedType*>(Args.Target) };
+
+	Target = Source.Quantize();
+}
+
+void FReplicatedViewStateNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	const auto& Source{ *reinterpret_cast<const QuantizedType*>(Args.Source) };
+	auto& Target{ *reinterpret_cast<SourceType*>(Args.Target) };
+
+	Target.Dequantize(Source);
+}
+
+bool FReplicatedViewStateNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	if (Args.bStateIsQuantized)
+	{
+		const auto& Value0{ *reinterpret_cast<const QuantizedType*>(Args.Source0) };
+		const auto& Value1{ *reinterpret_cast<const QuantizedType*>(Args.Source1) };
+
+		return Value0 == Value1;
+	}
+
+	const auto& Value0{ *reinterpret_cast<const SourceType*>(Args.Source0) };
+	const auto& Value1{ *reinterpret_cast<const SourceType*>(Args.Source1) };
+
+	return Value0 == Value1;
+}
+
+bool FReplicatedViewStateNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+{
+	// Every value is clamped when quantized, so any source value is valid
+
+	return true;
+}
+
+
+static const FName PropertyNetSerializerRegistry_NAME_ReplicatedViewState("ReplicatedViewState");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ReplicatedViewState, FReplicatedViewStateNetSerializer);
+
+FReplicatedViewStateNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{
+	UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ReplicatedViewState);
+}
+
+void FReplicatedViewStateNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+	UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_ReplicatedViewState);
+}
+
+}
+
+#endif
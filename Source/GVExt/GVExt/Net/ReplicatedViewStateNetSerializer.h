@@ -0,0 +1,25 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Iris/Serialization/NetSerializer.h"
+
+#include "ReplicatedViewStateNetSerializer.generated.h"
+
+
+/**
+ * Config of the Iris serializer for FReplicatedViewState
+ */
+USTRUCT()
+struct FReplicatedViewStateNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+
+#if UE_WITH_IRIS
+namespace UE::Net
+{
+	UE_NET_DECLARE_SERIALIZER(FReplicatedViewStateNetSerializer, GVEXT_API);
+}
+#endif
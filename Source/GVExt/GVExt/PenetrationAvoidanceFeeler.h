@@ -7,6 +7,10 @@
 
 /**
  * Struct defining a feeler ray used for camera penetration avoidance.
+ * 
+ * Note:
+ *	This only holds the configuration shared by all instances of a ViewMode class.
+ *	The per-instance trace timing is stored in the ViewMode.
  */
 USTRUCT()
 struct FPenetrationAvoidanceFeeler
@@ -19,7 +23,6 @@ public:
 		, PawnWeight(0)
 		, Extent(0)
 		, TraceInterval(0)
-		, FramesUntilNextTrace(0)
 	{
 	}
 
@@ -28,15 +31,13 @@ public:
 		const float& InWorldWeight,
 		const float& InPawnWeight,
 		const float& InExtent,
-		const int32& InTraceInterval = 0,
-		const int32& InFramesUntilNextTrace = 0
+		const int32& InTraceInterval = 0
 	)
 		: AdjustmentRot(InAdjustmentRot)
 		, WorldWeight(InWorldWeight)
 		, PawnWeight(InPawnWeight)
 		, Extent(InExtent)
 		, TraceInterval(InTraceInterval)
-		, FramesUntilNextTrace(InFramesUntilNextTrace)
 	{
 	}
 
@@ -72,10 +73,27 @@ public:
 	UPROPERTY(EditAnywhere)
 	int32 TraceInterval;
 
-	//
-	// Number of frames since this feeler was used
-	//
-	UPROPERTY(EditAnywhere)
-	int32 FramesUntilNextTrace;
+public:
+	bool operator==(const FPenetrationAvoidanceFeeler& Other) const
+	{
+		return (AdjustmentRot == Other.AdjustmentRot)
+			&& (WorldWeight == Other.WorldWeight)
+			&& (PawnWeight == Other.PawnWeight)
+			&& (Extent == Other.Extent)
+			&& (TraceInterval == Other.TraceInterval);
+	}
+
+	bool operator!=(const FPenetrationAvoidanceFeeler& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	/**
+	 * Returns the direction of this feeler in the basis of the main ray (X: forward, Y: right, Z: up)
+	 */
+	FVector GetLocalDirection() const
+	{
+		return FVector::ForwardVector.RotateAngleAxis(AdjustmentRot.Yaw, FVector::UpVector).RotateAngleAxis(AdjustmentRot.Pitch, FVector::RightVector);
+	}
 
 };
\ No newline at end of file
@@ -0,0 +1,342 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewTelemetrySummarizeCommandlet.h"
+
+#include "Telemetry/ViewTelemetryTypes.h"
+#include "GVExtLogs.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewTelemetrySummarizeCommandlet)
+
+
+namespace ViewTelemetrySummary
+{
+	/**
+	 * Histogram with fixed size buckets and an overflow bucket
+	 */
+	struct FHistogram
+	{
+	public:
+		FHistogram(const TCHAR* InName, float InBucketSize, int32 InNumBuckets)
+			: Name(InName), BucketSize(InBucketSize)
+		{
+			Counts.SetNumZeroed(InNumBuckets + 1);
+		}
+
+	public:
+		FString Name;
+		float BucketSize;
+		TArray<int64> Counts;
+		int64 Total{ 0 };
+		double Sum{ 0.0 };
+
+	public:
+		void Add(float Value)
+		{
+			const auto Index{ FMath::Clamp(FMath::FloorToInt32(Value / BucketSize), 0, Counts.Num() - 1) };
+
+			++Counts[Index];
+			++Total;
+			Sum += Value;
+		}
+
+		/**
+		 * Returns the upper bound of the bucket that contains the percentile
+		 */
+		float GetPercentile(float Percentile) const
+		{
+			const auto Target{ static_cast<int64>(FMath::CeilToDouble(Total * Percentile)) };
+			auto Accumulated{ static_cast<int64>(0) };
+
+			for (auto Index{ 0 }; Index < Counts.Num(); ++Index)
+			{
+				Accumulated += Counts[Index];
+
+				if (Accumulated >= Target)
+				{
+					return (Index + 1) * BucketSize;
+				}
+			}
+
+			return Counts.Num() * BucketSize;
+		}
+
+		void Log() const
+		{
+			UE_LOG(LogGVE, Display, TEXT("%s: %lld samples, mean %.3f, p50 <= %.3f, p95 <= %.3f, p99 <= %.3f"),
+				*Name, Total, (Total > 0) ? (Sum / Total) : 0.0, GetPercentile(0.5f), GetPercentile(0.95f), GetPercentile(0.99f));
+
+			const auto MaxCount{ FMath::Max(static_cast<int64>(1), FMath::Max(Counts)) };
+
+			for (auto Index{ 0 }; Index < Counts.Num(); ++Index)
+			{
+				if (Counts[Index] == 0)
+				{
+					continue;
+				}
+
+				const auto bOverflow{ Index == (Counts.Num() - 1) };
+				const auto Bar{ FString::ChrN(static_cast<int32>((Counts[Index] * 40) / MaxCount), TEXT('#')) };
+
+				UE_LOG(LogGVE, Display, TEXT("  %s%8.3f | %10lld | %s"), bOverflow ? TEXT(">=") : TEXT("< "), bOverflow ? (Index * BucketSize) : ((Index + 1) * BucketSize), Counts[Index], *Bar);
+			}
+		}
+
+		void AppendCsv(FString& Csv) const
+		{
+			for (auto Index{ 0 }; Index < Counts.Num(); ++Index)
+			{
+				Csv += FString::Printf(TEXT("%s,%f,%lld\n"), *Name, Index * BucketSize, Counts[Index]);
+			}
+		}
+	};
+
+	struct FViewModeSummary
+	{
+		int64 Frames{ 0 };
+		double EvaluationMsSum{ 0.0 };
+		int64 Switches{ 0 };
+	};
+
+	struct FSummary
+	{
+	public:
+		FSummary(float BucketMs)
+			: EvaluationMs(TEXT("EvaluationMs"), BucketMs, 40)
+			, StackDepth(TEXT("StackDepth"), 1.0f, 8)
+			, Sweeps(TEXT("SweepsPerFrame"), 1.0f, 16)
+			, SweepHits(TEXT("SweepHitsPerFrame"), 1.0f, 16)
+			, BlockedPct(TEXT("UnblockedPct"), 0.1f, 10)
+		{
+		}
+
+	public:
+		FHistogram EvaluationMs;
+		FHistogram StackDepth;
+		FHistogram Sweeps;
+		FHistogram SweepHits;
+		FHistogram BlockedPct;
+
+		TMap<FString, FViewModeSummary> ViewModes;
+		TMap<FString, int64> Transitions;
+
+	public:
+		/**
+		 * Read the records of a telemetry file. Returns false if it is not a telemetry file.
+		 */
+		bool ReadFile(const FString& FilePath)
+		{
+			TArray<uint8> Data;
+			if (!FFileHelper::LoadFileToArray(Data, *FilePath))
+			{
+				return false;
+			}
+
+			auto Reader{ FMemoryReader(Data) };
+
+			auto Magic{ static_cast<uint32>(0) };
+			auto Version{ static_cast<uint32>(0) };
+
+			Reader << Magic;
+			Reader << Version;
+
+			if ((Magic != ViewTelemetry::Magic) || (Version != ViewTelemetry::Version))
+			{
+				return false;
+			}
+
+			TMap<uint8, FString> ViewModeNames;
+
+			auto GetViewModeName
+			{
+				[&ViewModeNames](uint8 Index)
+				{
+					const auto* FoundName{ ViewModeNames.Find(Index) };
+					return FoundName ? *FoundName : FString(TEXT("None"));
+				}
+			};
+
+			// A session that did not close its file may end in the middle of a record
+
+			while (!Reader.AtEnd() && !Reader.IsError())
+			{
+				auto RecordType{ static_cast<uint8>(0) };
+				Reader << RecordType;
+
+				switch (static_cast<ViewTelemetry::ERecordType>(RecordType))
+				{
+				case ViewTelemetry::ERecordType::ViewModeName:
+				{
+					auto Index{ static_cast<uint8>(0) };
+					FString Name;
+
+					Reader << Index;
+					Reader << Name;
+
+					ViewModeNames.Add(Index, Name);
+					break;
+				}
+
+				case ViewTelemetry::ERecordType::Frame:
+				{
+					FViewTelemetryFrame Frame;
+					Reader << Frame;
+
+					if (Reader.IsError())
+					{
+						break;
+					}
+
+					EvaluationMs.Add(Frame.EvaluationMs);
+					StackDepth.Add(Frame.StackDepth);
+					Sweeps.Add(Frame.NumSweeps);
+					SweepHits.Add(Frame.NumSweepHits);
+					BlockedPct.Add(Frame.BlockedPct / 255.0f);
+
+					auto& ViewMode{ ViewModes.FindOrAdd(GetViewModeName(Frame.ViewModeIndex)) };
+					++ViewMode.Frames;
+					ViewMode.EvaluationMsSum += Frame.EvaluationMs;
+					break;
+				}
+
+				case ViewTelemetry::ERecordType::ViewModeSwitch:
+				{
+					auto FrameNumber{ static_cast<uint32>(0) };
+					auto FromIndex{ static_cast<uint8>(0) };
+					auto ToIndex{ static_cast<uint8>(0) };
+
+					Reader << FrameNumber;
+					Reader << FromIndex;
+					Reader << ToIndex;
+
+					if (Reader.IsError())
+					{
+						break;
+					}
+
+					const auto ToName{ GetViewModeName(ToIndex) };
+
+					++ViewModes.FindOrAdd(ToName).Switches;
+					++Transitions.FindOrAdd(FString::Printf(TEXT("%s -> %s"), *GetViewModeName(FromIndex), *ToName));
+					break;
+				}
+
+				default:
+					UE_LOG(LogGVE, Warning, TEXT("ViewTelemetrySummarize: Unknown record [%d] in [%s], skipping the rest of the file"), RecordType, *FilePath);
+					return true;
+				}
+			}
+
+			return true;
+		}
+
+		void Log() const
+		{
+			EvaluationMs.Log();
+			StackDepth.Log();
+			Sweeps.Log();
+			SweepHits.Log();
+			BlockedPct.Log();
+
+			UE_LOG(LogGVE, Display, TEXT("ViewModes:"));
+
+			for (const auto& [Name, ViewMode] : ViewModes)
+			{
+				UE_LOG(LogGVE, Display, TEXT("  %-48s %10lld frames, mean %.3f ms, %lld switches in"),
+					*Name, ViewMode.Frames, (ViewMode.Frames > 0) ? (ViewMode.EvaluationMsSum / ViewMode.Frames) : 0.0, ViewMode.Switches);
+			}
+
+			UE_LOG(LogGVE, Display, TEXT("Transitions:"));
+
+			for (const auto& [Transition, Count] : Transitions)
+			{
+				UE_LOG(LogGVE, Display, TEXT("  %-64s %10lld"), *Transition, Count);
+			}
+		}
+
+		FString ToCsv() const
+		{
+			FString Csv{ TEXT("Histogram,BucketMin,Count\n") };
+
+			EvaluationMs.AppendCsv(Csv);
+			StackDepth.AppendCsv(Csv);
+			Sweeps.AppendCsv(Csv);
+			SweepHits.AppendCsv(Csv);
+			BlockedPct.AppendCsv(Csv);
+
+			return Csv;
+		}
+	};
+}
+
+
+UViewTelemetrySummarizeCommandlet::UViewTelemetrySummarizeCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+
+int32 UViewTelemetrySummarizeCommandlet::Main(const FString& Params)
+{
+	FString FilesParam;
+	if (!FParse::Value(*Params, TEXT("Files="), FilesParam))
+	{
+		FilesParam = FPaths::ProjectSavedDir() / TEXT("Telemetry");
+	}
+
+	auto BucketMs{ 0.05f };
+	FParse::Value(*Params, TEXT("BucketMs="), BucketMs);
+
+	// Collect the files to summarize
+
+	TArray<FString> FilePaths;
+
+	if (FPaths::DirectoryExists(FilesParam))
+	{
+		IFileManager::Get().FindFilesRecursive(FilePaths, *FilesParam, TEXT("*.gvtl"), true, false);
+	}
+	else if (FPaths::FileExists(FilesParam))
+	{
+		FilePaths.Add(FilesParam);
+	}
+
+	if (FilePaths.IsEmpty())
+	{
+		UE_LOG(LogGVE, Error, TEXT("ViewTelemetrySummarize: No telemetry file found in [%s]"), *FilesParam);
+		return 1;
+	}
+
+	auto Summary{ ViewTelemetrySummary::FSummary(FMath::Max(BucketMs, 0.001f)) };
+
+	for (const auto& FilePath : FilePaths)
+	{
+		if (!Summary.ReadFile(FilePath))
+		{
+			UE_LOG(LogGVE, Warning, TEXT("ViewTelemetrySummarize: [%s] is not a telemetry file of this version"), *FilePath);
+		}
+	}
+
+	UE_LOG(LogGVE, Display, TEXT("ViewTelemetrySummarize: %d files"), FilePaths.Num());
+
+	Summary.Log();
+
+	FString CsvPath;
+	if (FParse::Value(*Params, TEXT("Csv="), CsvPath))
+	{
+		if (!FFileHelper::SaveStringToFile(Summary.ToCsv(), *CsvPath))
+		{
+			UE_LOG(LogGVE, Error, TEXT("ViewTelemetrySummarize: Failed to write [%s]"), *CsvPath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "ViewTelemetrySummarizeCommandlet.generated.h"
+
+
+/**
+ * Commandlet that summarizes the camera telemetry files recorded with "gvext.Telemetry.Enable" into histograms
+ * 
+ * Usage:
+ *	-run=ViewTelemetrySummarize -Files=<Directory or file> [-Csv=<Output file>] [-BucketMs=0.05]
+ * 
+ * Note:
+ *	The files of the Saved/Telemetry directory of the project are used if -Files is not specified.
+ */
+UCLASS()
+class UViewTelemetrySummarizeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UViewTelemetrySummarizeCommandlet(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+public:
+	virtual int32 Main(const FString& Params) override;
+
+};
@@ -0,0 +1,76 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Binary format of the camera telemetry stream
+ * 
+ * Note:
+ *	The file starts with the magic and the version, followed by records that each start with their ERecordType.
+ *	Records never span chunks, so the file can be read even if the session ended without closing it.
+ *	In that case the records still buffered by the writer (up to "gvext.Telemetry.FlushInterval" seconds) are lost.
+ */
+namespace ViewTelemetry
+{
+	static constexpr uint32 Magic{ 0x4C545647 }; // "GVTL"
+	static constexpr uint32 Version{ 1 };
+
+	enum class ERecordType : uint8
+	{
+		// Name of the ViewMode registered for an index (uint8 Index, FString Name)
+		ViewModeName,
+
+		// FViewTelemetryFrame
+		Frame,
+
+		// Switch of the ViewMode requested by the ViewerComponent (uint32 FrameNumber, uint8 FromIndex, uint8 ToIndex)
+		ViewModeSwitch,
+	};
+
+	//
+	// ViewMode index used when no ViewMode is applied
+	//
+	static constexpr uint8 NoViewModeIndex{ MAX_uint8 };
+}
+
+
+/**
+ * Telemetry of a single camera evaluation
+ */
+struct FViewTelemetryFrame
+{
+public:
+	FViewTelemetryFrame() {}
+
+public:
+	uint32 FrameNumber{ 0 };
+	float TimeSeconds{ 0.0f };
+	float EvaluationMs{ 0.0f };
+	uint8 StackDepth{ 0 };
+	uint8 ViewModeIndex{ ViewTelemetry::NoViewModeIndex };
+	uint8 NumSweeps{ 0 };
+	uint8 NumSweepHits{ 0 };
+
+	//
+	// Unblocked ratio of the camera distance quantized to 0-255 (255 if not blocked)
+	//
+	uint8 BlockedPct{ MAX_uint8 };
+
+public:
+	friend FArchive& operator<<(FArchive& Ar, FViewTelemetryFrame& Frame)
+	{
+		Ar << Frame.FrameNumber;
+		Ar << Frame.TimeSeconds;
+		Ar << Frame.EvaluationMs;
+		Ar << Frame.StackDepth;
+		Ar << Frame.ViewModeIndex;
+		Ar << Frame.NumSweeps;
+		Ar << Frame.NumSweepHits;
+		Ar << Frame.BlockedPct;
+		return Ar;
+	}
+
+};
@@ -0,0 +1,198 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewTelemetryWriter.h"
+
+#include "GVExtLogs.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+
+static TAutoConsoleVariable<int32> CVarTelemetryChunkSizeKB(
+	TEXT("gvext.Telemetry.ChunkSizeKB"),
+	64,
+	TEXT("Size in KB of the telemetry buffer handed to the background writer at once."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarTelemetryFlushInterval(
+	TEXT("gvext.Telemetry.FlushInterval"),
+	1.0f,
+	TEXT("Maximum time in seconds the telemetry records are kept in the buffer before being handed to the background writer."),
+	ECVF_Default);
+
+
+FViewTelemetryWriter::FViewTelemetryWriter(const FString& InFilePath)
+	: File(MakeShared<FViewTelemetryFile, ESPMode::ThreadSafe>(InFilePath))
+{
+	// The header is written with the first chunk
+
+	auto Writer{ FMemoryWriter(Buffer) };
+
+	auto Magic{ ViewTelemetry::Magic };
+	auto Version{ ViewTelemetry::Version };
+
+	Writer << Magic;
+	Writer << Version;
+
+	LastFlushTime = FPlatformTime::Seconds();
+
+	PreExitHandle = FCoreDelegates::OnPreExit.AddRaw(this, &FViewTelemetryWriter::HandlePreExit);
+}
+
+FViewTelemetryWriter::~FViewTelemetryWriter()
+{
+	FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+
+	// The pending tasks keep the file alive until the last records are written, so the game thread does not wait for them
+
+	Close();
+}
+
+
+void FViewTelemetryWriter::FlushIfDue()
+{
+	const auto ChunkSize{ FMath::Max(CVarTelemetryChunkSizeKB.GetValueOnGameThread(), 1) * 1024 };
+	const auto CurrentTime{ FPlatformTime::Seconds() };
+
+	if ((Buffer.Num() >= ChunkSize) || ((CurrentTime - LastFlushTime) >= CVarTelemetryFlushInterval.GetValueOnGameThread()))
+	{
+		Flush();
+	}
+}
+
+void FViewTelemetryWriter::HandlePreExit()
+{
+	// Background tasks may no longer run once the application starts shutting down
+
+	Close();
+
+	LastWriteTask.Wait();
+}
+
+uint8 FViewTelemetryWriter::GetViewModeIndex(FName ViewModeName)
+{
+	if (ViewModeName.IsNone())
+	{
+		return ViewTelemetry::NoViewModeIndex;
+	}
+
+	if (const auto* FoundIndex{ ViewModeIndices.Find(ViewModeName) })
+	{
+		return *FoundIndex;
+	}
+
+	// Indices are limited to a byte, the remaining ViewModes are recorded as unknown
+
+	if (ViewModeIndices.Num() >= ViewTelemetry::NoViewModeIndex)
+	{
+		return ViewTelemetry::NoViewModeIndex;
+	}
+
+	auto NewIndex{ static_cast<uint8>(ViewModeIndices.Num()) };
+	ViewModeIndices.Add(ViewModeName, NewIndex);
+
+	auto Writer{ FMemoryWriter(Buffer, false, true) };
+
+	auto RecordType{ static_cast<uint8>(ViewTelemetry::ERecordType::ViewModeName) };
+	auto NameString{ ViewModeName.ToString() };
+
+	Writer << RecordType;
+	Writer << NewIndex;
+	Writer << NameString;
+
+	return NewIndex;
+}
+
+void FViewTelemetryWriter::WriteFrame(FViewTelemetryFrame& Frame)
+{
+	auto Writer{ FMemoryWriter(Buffer, false, true) };
+
+	auto RecordType{ static_cast<uint8>(ViewTelemetry::ERecordType::Frame) };
+
+	Writer << RecordType;
+	Writer << Frame;
+
+	FlushIfDue();
+}
+
+void FViewTelemetryWriter::WriteViewModeSwitch(uint32 FrameNumber, uint8 FromIndex, uint8 ToIndex)
+{
+	auto Writer{ FMemoryWriter(Buffer, false, true) };
+
+	auto RecordType{ static_cast<uint8>(ViewTelemetry::ERecordType::ViewModeSwitch) };
+
+	Writer << RecordType;
+	Writer << FrameNumber;
+	Writer << FromIndex;
+	Writer << ToIndex;
+
+	FlushIfDue();
+}
+
+void FViewTelemetryWriter::Flush()
+{
+	if (Buffer.IsEmpty() || bClosed)
+	{
+		return;
+	}
+
+	LastWriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[File = File, Chunk = MoveTemp(Buffer)]()
+		{
+			if (File->bOpenFailed)
+			{
+				return;
+			}
+
+			// The file is opened by the first chunk so that the game thread never waits for the file system
+
+			if (!File->Handle.IsValid())
+			{
+				auto& PlatformFile{ FPlatformFileManager::Get().GetPlatformFile() };
+				PlatformFile.CreateDirectoryTree(*FPaths::GetPath(File->FilePath));
+
+				File->Handle.Reset(PlatformFile.OpenWrite(*File->FilePath));
+
+				if (!File->Handle.IsValid())
+				{
+					UE_LOG(LogGVE, Warning, TEXT("ViewTelemetryWriter: Failed to open [%s]"), *File->FilePath);
+
+					File->bOpenFailed = true;
+					return;
+				}
+			}
+
+			File->Handle->Write(Chunk.GetData(), Chunk.Num());
+		},
+		UE::Tasks::Prerequisites(LastWriteTask));
+
+	Buffer.Reset();
+
+	LastFlushTime = FPlatformTime::Seconds();
+}
+
+void FViewTelemetryWriter::Close()
+{
+	if (bClosed)
+	{
+		return;
+	}
+
+	Flush();
+
+	bClosed = true;
+
+	LastWriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[File = File]()
+		{
+			if (File->Handle.IsValid())
+			{
+				File->Handle->Flush();
+				File->Handle.Reset();
+			}
+		},
+		UE::Tasks::Prerequisites(LastWriteTask));
+}
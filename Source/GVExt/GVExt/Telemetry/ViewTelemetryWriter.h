@@ -0,0 +1,93 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Telemetry/ViewTelemetryTypes.h"
+
+#include "Tasks/Task.h"
+
+class IFileHandle;
+
+
+/**
+ * File written by the background tasks of FViewTelemetryWriter
+ */
+struct FViewTelemetryFile
+{
+public:
+	FViewTelemetryFile(const FString& InFilePath) : FilePath(InFilePath) {}
+
+public:
+	FString FilePath;
+	TUniquePtr<IFileHandle> Handle;
+	bool bOpenFailed{ false };
+
+};
+
+
+/**
+ * Buffered writer of the camera telemetry stream
+ * 
+ * Note:
+ *	Records are appended to a memory buffer on the game thread.
+ *	Full chunks are written to the file by background tasks that run one after another, so the game thread never does file I/O.
+ *	The buffer is also handed over at least every "gvext.Telemetry.FlushInterval" seconds, and the file is closed on application exit.
+ */
+class GVEXT_API FViewTelemetryWriter
+{
+public:
+	explicit FViewTelemetryWriter(const FString& InFilePath);
+	~FViewTelemetryWriter();
+
+protected:
+	TSharedRef<FViewTelemetryFile, ESPMode::ThreadSafe> File;
+
+	TArray<uint8> Buffer;
+
+	TMap<FName, uint8> ViewModeIndices;
+
+	//
+	// Last write task launched, the next one waits for it to keep the order of the chunks
+	//
+	UE::Tasks::FTask LastWriteTask;
+
+	double LastFlushTime{ 0.0 };
+
+	FDelegateHandle PreExitHandle;
+
+	bool bClosed{ false };
+
+protected:
+	/**
+	 * Hand the buffer to a background task if it exceeds "gvext.Telemetry.ChunkSizeKB" 
+	 * or was not handed over for "gvext.Telemetry.FlushInterval" seconds
+	 */
+	void FlushIfDue();
+
+	/**
+	 * Close the file and wait for the last records to be written before the application exits
+	 */
+	void HandlePreExit();
+
+public:
+	/**
+	 * Returns the index of the ViewMode in the stream, writing its name the first time it is seen
+	 */
+	uint8 GetViewModeIndex(FName ViewModeName);
+
+	void WriteFrame(FViewTelemetryFrame& Frame);
+	void WriteViewModeSwitch(uint32 FrameNumber, uint8 FromIndex, uint8 ToIndex);
+
+	/**
+	 * Hand the buffered records to a background task
+	 */
+	void Flush();
+
+	/**
+	 * Flush the buffered records and close the file once all writes are done
+	 */
+	void Close();
+
+	const FString& GetFilePath() const { return File->FilePath; }
+
+};
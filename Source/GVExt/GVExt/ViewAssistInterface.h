@@ -6,6 +6,8 @@
 
 #include "ViewAssistInterface.generated.h"
 
+class USplineComponent;
+
 
 UINTERFACE(BlueprintType)
 class UViewAssistInterface : public UInterface
@@ -37,4 +39,15 @@ public:
 	 */
 	virtual void OnCameraPenetratingTarget() {}
 
+	/**
+	 * The spline that rail cameras (UViewMode_Spline) should follow. If unimplemented, the spline is found by actor tag.
+	 */
+	virtual USplineComponent* GetCameraRailSpline() const { return nullptr; }
+
+	/**
+	 * The actors that group framing cameras (UViewMode_GroupFraming) should keep in frame.
+	 * If unimplemented, the view target and the actors found by tag are framed.
+	 */
+	virtual void GetCameraFramingTargets(TArray<AActor*>& OutTargets) const {}
+
 };
@@ -0,0 +1,29 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewBudgetSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewBudgetSubsystem)
+
+
+bool UViewBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE);
+}
+
+
+float UViewBudgetSubsystem::AddEvaluationCost(float EvaluationMs)
+{
+	// Start a new frame, the total is only carried over from the frame right before
+
+	if (CurrentFrame != GFrameCounter)
+	{
+		PreviousFrameSpentMs = (CurrentFrame == (GFrameCounter - 1)) ? CurrentFrameSpentMs : 0.0f;
+
+		CurrentFrame = GFrameCounter;
+		CurrentFrameSpentMs = 0.0f;
+	}
+
+	CurrentFrameSpentMs += EvaluationMs;
+
+	return PreviousFrameSpentMs;
+}
@@ -0,0 +1,38 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ViewBudgetSubsystem.generated.h"
+
+
+/**
+ * WorldSubsystem that accumulates the camera evaluation cost of all viewers in the world for the global budget
+ *
+ * Note:
+ *	Viewers are compared against the total of the previous frame,
+ *	so that the result does not depend on the order in which the viewers are updated in the current frame.
+ */
+UCLASS()
+class GVEXT_API UViewBudgetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UViewBudgetSubsystem() {}
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+protected:
+	uint64 CurrentFrame{ MAX_uint64 };
+	float CurrentFrameSpentMs{ 0.0f };
+	float PreviousFrameSpentMs{ 0.0f };
+
+public:
+	/**
+	 * Add the evaluation cost of a viewer to the current frame and returns the total of all viewers in the previous frame
+	 */
+	float AddEvaluationCost(float EvaluationMs);
+
+};
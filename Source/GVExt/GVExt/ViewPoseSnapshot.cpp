@@ -0,0 +1,79 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewPoseSnapshot.h"
+
+
+void FViewPoseSnapshotBuffer::Write(const FViewPoseSnapshot& InSnapshot)
+{
+	const auto Index{ NumWritten.load(std::memory_order_relaxed) };
+	auto& Slot{ Slots[Index % NumSlots] };
+
+	// An odd sequence marks the slot as being written
+
+	const auto Sequence{ Slot.Sequence.load(std::memory_order_relaxed) };
+	Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	FMemory::Memcpy(&Slot.Snapshot, &InSnapshot, sizeof(FViewPoseSnapshot));
+
+	Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+
+	NumWritten.store(Index + 1, std::memory_order_release);
+}
+
+bool FViewPoseSnapshotBuffer::TryReadSlot(int32 SlotIndex, FViewPoseSnapshot& OutSnapshot) const
+{
+	const auto& Slot{ Slots[SlotIndex] };
+
+	const auto SequenceBefore{ Slot.Sequence.load(std::memory_order_acquire) };
+
+	if ((SequenceBefore & 1) != 0)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutSnapshot, &Slot.Snapshot, sizeof(FViewPoseSnapshot));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return (Slot.Sequence.load(std::memory_order_relaxed) == SequenceBefore);
+}
+
+bool FViewPoseSnapshotBuffer::TryReadLatest(FViewPoseSnapshot& OutSnapshot) const
+{
+	const auto Written{ NumWritten.load(std::memory_order_acquire) };
+
+	if (Written == 0)
+	{
+		return false;
+	}
+
+	// Fall back to the previous slot if the latest one is being overwritten
+
+	if (TryReadSlot(static_cast<int32>((Written - 1) % NumSlots), OutSnapshot))
+	{
+		return true;
+	}
+
+	return (Written > 1) && TryReadSlot(static_cast<int32>((Written - 2) % NumSlots), OutSnapshot);
+}
+
+int32 FViewPoseSnapshotBuffer::ReadHistory(TArray<FViewPoseSnapshot>& OutSnapshots, int32 MaxCount) const
+{
+	OutSnapshots.Reset();
+
+	const auto Written{ NumWritten.load(std::memory_order_acquire) };
+	const auto NumToRead{ static_cast<int32>(FMath::Min<uint64>(Written, static_cast<uint64>(FMath::Clamp(MaxCount, 0, NumSlots)))) };
+
+	for (auto Offset{ 1 }; Offset <= NumToRead; ++Offset)
+	{
+		FViewPoseSnapshot Snapshot;
+
+		if (TryReadSlot(static_cast<int32>((Written - Offset) % NumSlots), Snapshot))
+		{
+			OutSnapshots.Add(Snapshot);
+		}
+	}
+
+	return OutSnapshots.Num();
+}
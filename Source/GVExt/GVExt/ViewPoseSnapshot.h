@@ -0,0 +1,87 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewModeTypes.h"
+
+#include <atomic>
+
+
+/**
+ * Camera pose of a single frame published by ViewerComponent
+ */
+struct FViewPoseSnapshot
+{
+public:
+	FViewPoseSnapshot() {}
+
+public:
+	FViewModeInfo View;
+
+	//
+	// Class of the ViewMode applied when the snapshot was taken
+	//
+	const UClass* ViewModeClass{ nullptr };
+
+	FRotator ControlRotationDelta{ FRotator::ZeroRotator };
+
+	//
+	// Angular velocity of the ControlRotation in degrees per second
+	//
+	FRotator AngularVelocity{ FRotator::ZeroRotator };
+
+	double Time{ 0.0 };
+	uint64 FrameNumber{ 0 };
+
+};
+
+
+/**
+ * Ring buffer of camera poses written by the game thread and readable from any thread without locks
+ * 
+ * Note:
+ *	Each slot is protected by a sequence counter (seqlock). Readers never wait; a read that overlaps a write fails
+ *	and the previous slot is used instead. The history is only guaranteed to be consistent for slots that are not being overwritten.
+ */
+class GVEXT_API FViewPoseSnapshotBuffer
+{
+public:
+	static constexpr int32 NumSlots{ 8 };
+
+public:
+	FViewPoseSnapshotBuffer() {}
+
+protected:
+	struct FSlot
+	{
+		std::atomic<uint32> Sequence{ 0 };
+		FViewPoseSnapshot Snapshot;
+	};
+
+	FSlot Slots[NumSlots];
+
+	//
+	// Total number of snapshots written. The latest one is in slot (NumWritten - 1) % NumSlots.
+	//
+	std::atomic<uint64> NumWritten{ 0 };
+
+protected:
+	bool TryReadSlot(int32 SlotIndex, FViewPoseSnapshot& OutSnapshot) const;
+
+public:
+	/**
+	 * Publish a new snapshot. Must only be called from a single writer thread.
+	 */
+	void Write(const FViewPoseSnapshot& InSnapshot);
+
+	/**
+	 * Read the latest consistent snapshot. Returns false if nothing has been published yet.
+	 */
+	bool TryReadLatest(FViewPoseSnapshot& OutSnapshot) const;
+
+	/**
+	 * Read up to MaxCount consistent snapshots from the newest to the oldest and returns the number read
+	 */
+	int32 ReadHistory(TArray<FViewPoseSnapshot>& OutSnapshots, int32 MaxCount = NumSlots) const;
+
+};
@@ -3,17 +3,118 @@
 #include "ViewerComponent.h"
 
 #include "Mode/ViewModeStack.h"
+#include "Telemetry/ViewTelemetryWriter.h"
+#include "ViewBudgetSubsystem.h"
 #include "GVExtLogs.h"
 
 #include "InitState/InitStateTags.h"
 #include "InitState/InitStateComponent.h"
 
 #include "Components/GameFrameworkComponentManager.h"
+#include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "RenderingThread.h"
+#include "SceneView.h"
+#include "SceneViewExtension.h"
+#include "Stats/Stats.h"
+#include "UObject/Package.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ViewerComponent)
 
 
+DECLARE_STATS_GROUP(TEXT("GVExt"), STATGROUP_GVExt, STATCAT_Advanced);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input To Camera Evaluate (ms)"), STAT_GVExt_InputToEvaluate, STATGROUP_GVExt);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input To View Submit (ms)"), STAT_GVExt_InputToSubmit, STATGROUP_GVExt);
+
+CSV_DEFINE_CATEGORY(GVExt, true);
+
+
+/**
+ * Scene view extension that samples the input latency when the view family of the player is submitted
+ */
+class FViewerInputLatencyViewExtension : public FWorldSceneViewExtension
+{
+public:
+	FViewerInputLatencyViewExtension(const FAutoRegister& AutoRegister, UWorld* InWorld, const TSharedRef<FViewerInputLatencyState, ESPMode::ThreadSafe>& InState)
+		: FWorldSceneViewExtension(AutoRegister, InWorld)
+		, State(InState)
+	{
+	}
+
+protected:
+	TSharedRef<FViewerInputLatencyState, ESPMode::ThreadSafe> State;
+
+public:
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override {}
+
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+		if (State->PendingSubmitInputTime < 0.0)
+		{
+			return;
+		}
+
+		// Scene captures of the same world are not what the player sees
+
+		for (const auto* View : InViewFamily.Views)
+		{
+			if (View && View->bIsSceneCapture)
+			{
+				return;
+			}
+		}
+
+		const auto InputTime{ State->PendingSubmitInputTime };
+		State->PendingSubmitInputTime = -1.0;
+
+		// Enqueued before the renderer enqueues this view family, so the rendering thread sees it in order
+
+		ENQUEUE_RENDER_COMMAND(GVExtBeginInputLatencyViewFamily)(
+			[State = State, InputTime](FRHICommandListImmediate& RHICmdList)
+			{
+				State->RenderInputTime = InputTime;
+			});
+	}
+
+	virtual void PostRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override
+	{
+		if (State->RenderInputTime < 0.0)
+		{
+			return;
+		}
+
+		const auto InputToSubmitMs{ static_cast<float>((FPlatformTime::Seconds() - State->RenderInputTime) * 1000.0) };
+		State->RenderInputTime = -1.0;
+
+		State->InputToSubmitMs.store(InputToSubmitMs, std::memory_order_relaxed);
+
+		SET_FLOAT_STAT(STAT_GVExt_InputToSubmit, InputToSubmitMs);
+		CSV_CUSTOM_STAT(GVExt, InputToSubmitMs, InputToSubmitMs, ECsvCustomStatOp::Set);
+	}
+
+};
+
+
+static TAutoConsoleVariable<float> CVarBudgetGlobalMs(
+	TEXT("gvext.Budget.GlobalMs"),
+	0.0f,
+	TEXT("Budget in milliseconds for the camera evaluation of all viewers in a frame. 0 disables the global budget."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarTelemetryEnable(
+	TEXT("gvext.Telemetry.Enable"),
+	false,
+	TEXT("If true, the camera telemetry of all local viewers is streamed to the Saved/Telemetry directory."),
+	ECVF_Default);
+
+
 const FName UViewerComponent::NAME_ActorFeatureName("Viewer");
 
 UViewerComponent::UViewerComponent(const FObjectInitializer& ObjectInitializer)
@@ -29,6 +130,13 @@ void UViewerComponent::OnRegister()
 
 	CameraModeStack = NewObject<UViewModeStack>(this);
 
+	// Replication is only needed when the view state is shared
+
+	if (bReplicateViewState)
+	{
+		SetIsReplicated(true);
+	}
+
 	// This component can only be added to classes derived from APawn
 
 	const auto* Pawn{ GetPawn<APawn>() };
@@ -49,6 +157,11 @@ void UViewerComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	for (const auto& WarmViewMode : WarmViewModes)
+	{
+		AddWarmViewMode(WarmViewMode);
+	}
+
 	// Start listening for changes in the initialization state of all features 
 	// related to the Pawn that owns this component.
 
@@ -65,12 +178,33 @@ void UViewerComponent::BeginPlay()
 
 void UViewerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	// Recycle the ViewMode instances for the next Pawn
+
+	if (CameraModeStack)
+	{
+		CameraModeStack->ReleaseViewModes();
+	}
+
+	CloseTelemetry();
+
+	InputLatencyViewExtension.Reset();
+
 	UnregisterInitStateFeature();
 
 	Super::EndPlay(EndPlayReason);
 }
 
 
+void UViewerComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client is the source of the view state
+
+	DOREPLIFETIME_CONDITION(ThisClass, ReplicatedViewState, COND_SkipOwner);
+}
+
+
 bool UViewerComponent::CanChangeInitState(UGameFrameworkComponentManager* Manager, FGameplayTag CurrentState, FGameplayTag DesiredState) const
 {
 	check(Manager);
@@ -210,17 +344,81 @@ void UViewerComponent::InitializeViewMode(TSubclassOf<UViewMode> InViewModeClass
 	}
 }
 
+void UViewerComponent::RefreshViewModeOverride()
+{
+	OverrideViewMode = ViewModeOverrides.GetWinningViewMode();
+}
+
+FViewModeOverrideHandle UViewerComponent::AddViewModeOverride(TSubclassOf<UViewMode> InViewModeClass, FGameplayTag OverrideTag, int32 Priority)
+{
+	const auto NewHandle{ ViewModeOverrides.AddOverride(InViewModeClass, OverrideTag, Priority) };
+
+	RefreshViewModeOverride();
+
+	return NewHandle;
+}
+
+bool UViewerComponent::RemoveViewModeOverride(FViewModeOverrideHandle& Handle)
+{
+	const auto bRemoved{ ViewModeOverrides.RemoveOverride(Handle) };
+
+	Handle.Invalidate();
+
+	if (bRemoved)
+	{
+		RefreshViewModeOverride();
+	}
+
+	return bRemoved;
+}
+
+int32 UViewerComponent::RemoveViewModeOverridesByTag(FGameplayTag OverrideTag)
+{
+	const auto NumRemoved{ ViewModeOverrides.RemoveOverridesByTag(OverrideTag) };
+
+	if (NumRemoved > 0)
+	{
+		RefreshViewModeOverride();
+	}
+
+	return NumRemoved;
+}
+
 void UViewerComponent::SetViewModeOverride(TSubclassOf<UViewMode> InViewModeClass)
 {
-	if (OverrideViewMode != InViewModeClass)
+	// Re-adding the same request would move it in front of the other requests with the same priority
+
+	if (ViewModeOverrides.FindViewModeClass(LegacyOverrideHandle) == InViewModeClass)
 	{
-		OverrideViewMode = InViewModeClass;
+		return;
 	}
+
+	ViewModeOverrides.RemoveOverride(LegacyOverrideHandle);
+
+	LegacyOverrideHandle = ViewModeOverrides.AddOverride(InViewModeClass, FGameplayTag::EmptyTag, 0);
+
+	RefreshViewModeOverride();
 }
 
 void UViewerComponent::ClearViewModeOverride()
 {
-	OverrideViewMode = nullptr;
+	RemoveViewModeOverride(LegacyOverrideHandle);
+}
+
+void UViewerComponent::AddWarmViewMode(TSubclassOf<UViewMode> InViewModeClass)
+{
+	if (CameraModeStack)
+	{
+		CameraModeStack->AddWarmViewMode(InViewModeClass);
+	}
+}
+
+void UViewerComponent::RemoveWarmViewMode(TSubclassOf<UViewMode> InViewModeClass)
+{
+	if (CameraModeStack)
+	{
+		CameraModeStack->RemoveWarmViewMode(InViewModeClass);
+	}
 }
 
 
@@ -228,12 +426,36 @@ void UViewerComponent::GetCameraView(float DeltaTime, FMinimalViewInfo& DesiredV
 {
 	check(CameraModeStack);
 
-	if (auto Class{ DetermineViewMode() })
+	const auto Class{ DetermineViewMode() };
+
+	// If this Pawn has already been evaluated in this frame for another viewer, reuse the result.
+
+	if (bShareEvaluationInFrame && (CachedEvaluationFrame == GFrameCounter) && (CachedEvaluationViewMode == Class))
+	{
+		ApplyViewModeInfo(CachedEvaluationInfo, DesiredView);
+		return;
+	}
+
+	const auto StartCycles{ FPlatformTime::Cycles64() };
+
+	if (Class)
 	{
 		CameraModeStack->PushViewMode(Class);
 	}
 
 	ComputeCameraView(DeltaTime, DesiredView);
+
+	CachedEvaluationFrame = GFrameCounter;
+	CachedEvaluationViewMode = Class;
+
+	if (bPublishPoseSnapshot)
+	{
+		PublishPoseSnapshot(DeltaTime, Class);
+	}
+
+	UpdateViewQualityLevel(static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)));
+
+	RecordTelemetry(Class);
 }
 
 void UViewerComponent::ComputeCameraView(float DeltaTime, FMinimalViewInfo& DesiredView)
@@ -250,9 +472,32 @@ void UViewerComponent::ComputeCameraView(float DeltaTime, FMinimalViewInfo& Desi
 	SetWorldLocationAndRotation(CameraModeView.Location, CameraModeView.Rotation);
 	
 	FieldOfView = CameraModeView.FieldOfView;
-	DesiredView.Location = CameraModeView.Location;
-	DesiredView.Rotation = CameraModeView.Rotation;
-	DesiredView.FOV = CameraModeView.FieldOfView;
+
+	ApplyViewModeInfo(CameraModeView, DesiredView);
+
+	CachedEvaluationInfo = CameraModeView;
+
+	if (!ViewTraceRequests.IsEmpty())
+	{
+		UpdateViewTraces(CameraModeView);
+	}
+
+	if (bMeasureInputLatency)
+	{
+		MeasureInputLatency();
+	}
+
+	if (bReplicateViewState)
+	{
+		UpdateReplicatedViewState(CameraModeView);
+	}
+}
+
+void UViewerComponent::ApplyViewModeInfo(const FViewModeInfo& InViewModeInfo, FMinimalViewInfo& DesiredView) const
+{
+	DesiredView.Location = InViewModeInfo.Location;
+	DesiredView.Rotation = InViewModeInfo.Rotation;
+	DesiredView.FOV = InViewModeInfo.FieldOfView;
 	DesiredView.OrthoWidth = OrthoWidth;
 	DesiredView.OrthoNearClipPlane = OrthoNearClipPlane;
 	DesiredView.OrthoFarClipPlane = OrthoFarClipPlane;
@@ -268,7 +513,433 @@ void UViewerComponent::ComputeCameraView(float DeltaTime, FMinimalViewInfo& Desi
 }
 
 
+void UViewerComponent::UpdateViewQualityLevel(float EvaluationMs)
+{
+	LastEvaluationMs = EvaluationMs;
+
+	if (!bEnableEvaluationBudget)
+	{
+		ViewQualityLevel = EViewQualityLevel::Full;
+		return;
+	}
+
+	// Accumulate the cost of all viewers of the world and compare against the total of the previous frame
+
+	auto* World{ GetWorld() };
+	auto* BudgetSubsystem{ World ? World->GetSubsystem<UViewBudgetSubsystem>() : nullptr };
+
+	const auto GlobalSpentMs{ BudgetSubsystem ? BudgetSubsystem->AddEvaluationCost(EvaluationMs) : 0.0f };
+
+	// Smooth the cost so that a single spike does not change the level
+
+	SmoothedEvaluationMs = FMath::Lerp(SmoothedEvaluationMs, EvaluationMs, 0.1f);
+
+	const auto GlobalBudgetMs{ CVarBudgetGlobalMs.GetValueOnGameThread() };
+	const auto bHasGlobalBudget{ GlobalBudgetMs > 0.0f };
+
+	const auto bOverBudget
+	{
+		(SmoothedEvaluationMs > EvaluationBudgetMs) || 
+		(bHasGlobalBudget && (GlobalSpentMs > GlobalBudgetMs))
+	};
+
+	const auto bUnderRecoverThreshold
+	{
+		(SmoothedEvaluationMs < (EvaluationBudgetMs * BudgetRecoverRatio)) &&
+		(!bHasGlobalBudget || (GlobalSpentMs < (GlobalBudgetMs * BudgetRecoverRatio)))
+	};
+
+	OverBudgetFrames = bOverBudget ? (OverBudgetFrames + 1) : 0;
+	UnderBudgetFrames = bUnderRecoverThreshold ? (UnderBudgetFrames + 1) : 0;
+
+	const auto CurrentLevel{ static_cast<uint8>(ViewQualityLevel) };
+	const auto LowestLevel{ static_cast<uint8>(EViewQualityLevel::COUNT) - 1 };
+
+	// Step down one level at a time while over budget
+
+	if ((OverBudgetFrames >= BudgetDowngradeFrames) && (CurrentLevel < LowestLevel))
+	{
+		ViewQualityLevel = static_cast<EViewQualityLevel>(CurrentLevel + 1);
+		OverBudgetFrames = 0;
+
+		UE_LOG(LogGVE, Verbose, TEXT("[%s] Camera over budget (%.3f ms), lowered quality to %s"), *GetNameSafe(GetOwner()), SmoothedEvaluationMs, *UEnum::GetValueAsString(ViewQualityLevel));
+	}
+
+	// Step up one level at a time after staying well under budget
+
+	else if ((UnderBudgetFrames >= BudgetRecoverFrames) && (CurrentLevel > 0))
+	{
+		ViewQualityLevel = static_cast<EViewQualityLevel>(CurrentLevel - 1);
+		UnderBudgetFrames = 0;
+
+		UE_LOG(LogGVE, Verbose, TEXT("[%s] Camera under budget (%.3f ms), raised quality to %s"), *GetNameSafe(GetOwner()), SmoothedEvaluationMs, *UEnum::GetValueAsString(ViewQualityLevel));
+	}
+}
+
+
+void UViewerComponent::UpdateReplicatedViewState(const FViewModeInfo& InViewModeInfo)
+{
+	const auto* Pawn{ GetPawn<APawn>() };
+
+	if (!Pawn || !Pawn->IsLocallyControlled())
+	{
+		return;
+	}
+
+	FReplicatedViewState NewViewState;
+	NewViewState.RelativeLocation = InViewModeInfo.Location - Pawn->GetActorLocation();
+	NewViewState.Rotation = InViewModeInfo.Rotation;
+	NewViewState.FieldOfView = InViewModeInfo.FieldOfView;
+	NewViewState.ViewModeId = static_cast<uint8>(ReplicatedViewModes.IndexOfByKey(DetermineViewMode()) + 1);
+
+	// Send at an adaptive rate: as soon as the view changes noticeably, but no more often than the minimum interval
+
+	const auto CurrentTime{ GetWorld()->GetRealTimeSeconds() };
+	const auto TimeSinceLastSend{ CurrentTime - LastViewStateSendTime };
+
+	if (TimeSinceLastSend < ViewStateMinSendInterval)
+	{
+		return;
+	}
+
+	const auto bChanged
+	{
+		(NewViewState.ViewModeId != LastSentViewState.ViewModeId) ||
+		!NewViewState.RelativeLocation.Equals(LastSentViewState.RelativeLocation, ViewStateLocationThreshold) ||
+		!NewViewState.Rotation.Equals(LastSentViewState.Rotation, ViewStateRotationThreshold) ||
+		!FMath::IsNearlyEqual(NewViewState.FieldOfView, LastSentViewState.FieldOfView, 1.0f)
+	};
+
+	if (!bChanged && (TimeSinceLastSend < ViewStateMaxSendInterval))
+	{
+		return;
+	}
+
+	LastSentViewState = NewViewState;
+	LastViewStateSendTime = CurrentTime;
+
+	UE_LOG(LogGVE, VeryVerbose, TEXT("[%s] Send view state: %u bits"), *GetNameSafe(GetOwner()), NewViewState.Quantize().GetSerializedBits());
+
+	if (GetOwner()->HasAuthority())
+	{
+		ReceiveReplicatedViewState(NewViewState);
+		ReplicatedViewState = NewViewState;
+	}
+	else
+	{
+		ServerUpdateViewState(NewViewState);
+	}
+}
+
+void UViewerComponent::ReceiveReplicatedViewState(const FReplicatedViewState& NewViewState)
+{
+	const auto CurrentTime{ GetWorld()->GetRealTimeSeconds() };
+
+	// Interpolate over the interval at which the updates actually arrive
+
+	const auto bFirstReceive{ LastViewStateReceiveTime <= 0.0 };
+
+	InterpolationStartViewState = GetInterpolatedViewState();
+	ViewStateInterpolationTime = bFirstReceive ? 0.0f : FMath::Min(static_cast<float>(CurrentTime - LastViewStateReceiveTime), ViewStateMaxSendInterval);
+	LastViewStateReceiveTime = CurrentTime;
+}
+
+FReplicatedViewState UViewerComponent::GetInterpolatedViewState() const
+{
+	if (ViewStateInterpolationTime <= 0.0f)
+	{
+		return ReplicatedViewState;
+	}
+
+	const auto Alpha{ FMath::Clamp(static_cast<float>(GetWorld()->GetRealTimeSeconds() - LastViewStateReceiveTime) / ViewStateInterpolationTime, 0.0f, 1.0f) };
+
+	auto Result{ ReplicatedViewState };
+	Result.RelativeLocation = FMath::Lerp(InterpolationStartViewState.RelativeLocation, ReplicatedViewState.RelativeLocation, Alpha);
+	Result.Rotation = FMath::Lerp(InterpolationStartViewState.Rotation, ReplicatedViewState.Rotation, Alpha);
+	Result.FieldOfView = FMath::Lerp(InterpolationStartViewState.FieldOfView, ReplicatedViewState.FieldOfView, Alpha);
+
+	return Result;
+}
+
+void UViewerComponent::ServerUpdateViewState_Implementation(const FReplicatedViewState& NewViewState)
+{
+	ReceiveReplicatedViewState(NewViewState);
+	ReplicatedViewState = NewViewState;
+}
+
+void UViewerComponent::OnRep_ReplicatedViewState(const FReplicatedViewState& OldViewState)
+{
+	// The new state has already been written, so interpolate from the state that was being displayed
+
+	const auto NewViewState{ ReplicatedViewState };
+
+	ReplicatedViewState = OldViewState;
+	ReceiveReplicatedViewState(NewViewState);
+	ReplicatedViewState = NewViewState;
+}
+
+bool UViewerComponent::GetReplicatedView(FVector& OutLocation, FRotator& OutRotation, float& OutFieldOfView) const
+{
+	const auto* Pawn{ GetPawn<APawn>() };
+
+	if (!bReplicateViewState || !Pawn || (LastViewStateReceiveTime <= 0.0))
+	{
+		return false;
+	}
+
+	const auto ViewState{ GetInterpolatedViewState() };
+
+	OutLocation = Pawn->GetActorLocation() + ViewState.RelativeLocation;
+	OutRotation = ViewState.Rotation;
+	OutFieldOfView = ViewState.FieldOfView;
+
+	return true;
+}
+
+TSubclassOf<UViewMode> UViewerComponent::GetReplicatedViewMode() const
+{
+	const auto Index{ static_cast<int32>(ReplicatedViewState.ViewModeId) - 1 };
+
+	return ReplicatedViewModes.IsValidIndex(Index) ? ReplicatedViewModes[Index] : nullptr;
+}
+
+
+void UViewerComponent::UpdateViewTraces(const FViewModeInfo& InViewModeInfo)
+{
+	auto* World{ GetWorld() };
+	if (!World)
+	{
+		return;
+	}
+
+	// Merge the requests into one trace per channel with the longest distance
+
+	ViewTraceResults.Reset();
+
+	for (const auto& Request : ViewTraceRequests)
+	{
+		auto* Result{ ViewTraceResults.FindByPredicate([&Request](const FViewTraceChannelResult& Item) { return Item.TraceChannel == Request.TraceChannel; }) };
+
+		if (Result)
+		{
+			Result->MaxDistance = FMath::Max(Result->MaxDistance, Request.Distance);
+		}
+		else
+		{
+			auto& NewResult{ ViewTraceResults.AddDefaulted_GetRef() };
+			NewResult.TraceChannel = Request.TraceChannel;
+			NewResult.MaxDistance = Request.Distance;
+		}
+	}
+
+	auto Params{ FCollisionQueryParams(SCENE_QUERY_STAT(ViewTrace), false, GetOwner()) };
+
+	const auto Start{ InViewModeInfo.Location };
+	const auto Direction{ InViewModeInfo.Rotation.Vector() };
+
+	for (auto& Result : ViewTraceResults)
+	{
+		Result.bBlockingHit = World->LineTraceSingleByChannel(Result.Hit, Start, Start + (Direction * Result.MaxDistance), Result.TraceChannel, Params);
+	}
+}
+
+void UViewerComponent::PublishFeelerTraceResult(const FViewFeelerTraceResult& InResult)
+{
+	FeelerTraceResult = InResult;
+	FeelerTraceResult.FrameNumber = GFrameCounter;
+}
+
+bool UViewerComponent::GetFeelerTraceResult(FViewFeelerTraceResult& OutResult, int32& OutFrameAge) const
+{
+	if (FeelerTraceResult.FrameNumber == 0)
+	{
+		return false;
+	}
+
+	OutResult = FeelerTraceResult;
+	OutFrameAge = static_cast<int32>(FMath::Min<uint64>(GFrameCounter - FeelerTraceResult.FrameNumber, MAX_int32));
+
+	return true;
+}
+
+FViewTraceRequestHandle UViewerComponent::AddViewTraceRequest(ECollisionChannel TraceChannel, float Distance)
+{
+	auto& NewRequest{ ViewTraceRequests.AddDefaulted_GetRef() };
+	NewRequest.Handle = FViewTraceRequestHandle::GenerateNewHandle();
+	NewRequest.TraceChannel = TraceChannel;
+	NewRequest.Distance = FMath::Max(Distance, 0.0f);
+
+	return NewRequest.Handle;
+}
+
+bool UViewerComponent::RemoveViewTraceRequest(FViewTraceRequestHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return false;
+	}
+
+	const auto NumRemoved{ ViewTraceRequests.RemoveAll([&Handle](const FViewTraceRequest& Request) { return Request.Handle == Handle; }) };
+
+	Handle.Invalidate();
+
+	if (ViewTraceRequests.IsEmpty())
+	{
+		ViewTraceResults.Reset();
+	}
+
+	return (NumRemoved > 0);
+}
+
+bool UViewerComponent::GetViewTraceResult(FViewTraceRequestHandle Handle, FHitResult& OutHit) const
+{
+	const auto* Request{ ViewTraceRequests.FindByPredicate([&Handle](const FViewTraceRequest& Item) { return Item.Handle == Handle; }) };
+	if (!Request)
+	{
+		return false;
+	}
+
+	const auto* Result{ ViewTraceResults.FindByPredicate([Request](const FViewTraceChannelResult& Item) { return Item.TraceChannel == Request->TraceChannel; }) };
+	if (!Result)
+	{
+		return false;
+	}
+
+	// The shared trace may be longer than this request, so its hit is only exposed within the requested distance
+
+	if (!Result->bBlockingHit || (Result->Hit.Distance > Request->Distance))
+	{
+		OutHit = FHitResult();
+		return false;
+	}
+
+	OutHit = Result->Hit;
+
+	return true;
+}
+
+
+void UViewerComponent::PublishPoseSnapshot(float DeltaTime, TSubclassOf<UViewMode> ViewModeClass)
+{
+	FViewPoseSnapshot Snapshot;
+	Snapshot.View = CachedEvaluationInfo;
+	Snapshot.ViewModeClass = ViewModeClass.Get();
+	Snapshot.ControlRotationDelta = ControlRotationDelta.GetNormalized();
+	Snapshot.AngularVelocity = (DeltaTime > UE_KINDA_SMALL_NUMBER) ? (Snapshot.ControlRotationDelta * (1.0f / DeltaTime)) : FRotator::ZeroRotator;
+	Snapshot.Time = FPlatformTime::Seconds();
+	Snapshot.FrameNumber = GFrameCounter;
+
+	PoseSnapshots->Write(Snapshot);
+}
+
+
+void UViewerComponent::NotifyControlInput(double InputTimeSeconds)
+{
+	if (!bMeasureInputLatency)
+	{
+		return;
+	}
+
+	const auto InputTime{ (InputTimeSeconds < 0.0) ? FPlatformTime::Seconds() : InputTimeSeconds };
+
+	// Keep the oldest input so that the worst latency of the frame is measured
+
+	if ((PendingInputTime < 0.0) || (InputTime < PendingInputTime))
+	{
+		PendingInputTime = InputTime;
+	}
+}
+
+void UViewerComponent::MeasureInputLatency()
+{
+	if (PendingInputTime < 0.0)
+	{
+		return;
+	}
+
+	const auto InputTime{ PendingInputTime };
+	PendingInputTime = -1.0;
+
+	InputToEvaluateMs = static_cast<float>((FPlatformTime::Seconds() - InputTime) * 1000.0);
+
+	SET_FLOAT_STAT(STAT_GVExt_InputToEvaluate, InputToEvaluateMs);
+	CSV_CUSTOM_STAT(GVExt, InputToEvaluateMs, InputToEvaluateMs, ECsvCustomStatOp::Set);
+
+	// Sampled when the next view family of this world has been rendered
+
+	if (!InputLatencyViewExtension.IsValid())
+	{
+		InputLatencyViewExtension = FSceneViewExtensions::NewExtension<FViewerInputLatencyViewExtension>(GetWorld(), InputLatencyState);
+	}
+
+	const auto PendingSubmitInputTime{ InputLatencyState->PendingSubmitInputTime };
+	if ((PendingSubmitInputTime < 0.0) || (InputTime < PendingSubmitInputTime))
+	{
+		InputLatencyState->PendingSubmitInputTime = InputTime;
+	}
+}
+
+
 UViewerComponent* UViewerComponent::FindViewerComponent(const APawn* Pawn)
 {
 	return (Pawn ? Pawn->FindComponentByClass<UViewerComponent>() : nullptr);
 }
+
+
+void UViewerComponent::RecordTelemetry(TSubclassOf<UViewMode> ViewModeClass)
+{
+	if (!bRecordTelemetry && !CVarTelemetryEnable.GetValueOnGameThread())
+	{
+		// Close the stream when disabled at runtime so that the file is complete
+
+		CloseTelemetry();
+		return;
+	}
+
+	if (!TelemetryWriter.IsValid())
+	{
+		// The PIE instance and a guid keep the files of several clients recording at the same time apart
+
+		const auto PIEInstanceID{ GetWorld() ? GetWorld()->GetOutermost()->GetPIEInstanceID() : INDEX_NONE };
+		const auto FileName{ FString::Printf(TEXT("GVExt_%s_PIE%d_%s_%s.gvtl"),
+			*GetNameSafe(GetOwner()), PIEInstanceID, *FDateTime::Now().ToString(), *FGuid::NewGuid().ToString(EGuidFormats::Digits)) };
+
+		TelemetryWriter = MakeShared<FViewTelemetryWriter>(FPaths::ProjectSavedDir() / TEXT("Telemetry") / FileName);
+		LastTelemetryViewModeIndex = ViewTelemetry::NoViewModeIndex;
+	}
+
+	const auto ViewModeIndex{ TelemetryWriter->GetViewModeIndex(ViewModeClass ? ViewModeClass->GetFName() : NAME_None) };
+
+	if (ViewModeIndex != LastTelemetryViewModeIndex)
+	{
+		TelemetryWriter->WriteViewModeSwitch(static_cast<uint32>(GFrameCounter), LastTelemetryViewModeIndex, ViewModeIndex);
+		LastTelemetryViewModeIndex = ViewModeIndex;
+	}
+
+	FViewTelemetryFrame Frame;
+	Frame.FrameNumber = static_cast<uint32>(GFrameCounter);
+	Frame.TimeSeconds = GetWorld()->GetTimeSeconds();
+	Frame.EvaluationMs = LastEvaluationMs;
+	Frame.StackDepth = static_cast<uint8>(FMath::Min<int32>(CameraModeStack->GetStackDepth(), MAX_uint8));
+	Frame.ViewModeIndex = ViewModeIndex;
+
+	// The feelers are only counted in the frames they were updated
+
+	if (FeelerTraceResult.FrameNumber == GFrameCounter)
+	{
+		Frame.NumSweeps = static_cast<uint8>(FMath::Min<int32>(FeelerTraceResult.NumSweeps, MAX_uint8));
+		Frame.NumSweepHits = static_cast<uint8>(FMath::Min<int32>(FeelerTraceResult.NumSweepHits, MAX_uint8));
+		Frame.BlockedPct = static_cast<uint8>(FMath::RoundToInt32(FMath::Clamp(FeelerTraceResult.BlockedPct, 0.0f, 1.0f) * MAX_uint8));
+	}
+
+	TelemetryWriter->WriteFrame(Frame);
+}
+
+void UViewerComponent::CloseTelemetry()
+{
+	if (TelemetryWriter.IsValid())
+	{
+		TelemetryWriter->Close();
+		TelemetryWriter.Reset();
+	}
+}
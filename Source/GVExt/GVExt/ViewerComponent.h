@@ -6,13 +6,54 @@
 #include "Components/GameFrameworkInitStateInterface.h"
 
 #include "Mode/ViewModeTypes.h"
+#include "Mode/ViewModeOverrideTypes.h"
+#include "Net/ReplicatedViewState.h"
+#include "Collision/ViewTraceTypes.h"
+#include "ViewPoseSnapshot.h"
 
 #include "GameplayTagContainer.h"
 
+#include <atomic>
+
 #include "ViewerComponent.generated.h"
 
 class UViewModeStack;
 class UViewMode;
+class FViewTelemetryWriter;
+class FViewerInputLatencyViewExtension;
+
+
+/**
+ * Input latency measurement shared with the rendering thread
+ */
+struct FViewerInputLatencyState
+{
+public:
+	FViewerInputLatencyState() {}
+
+public:
+	//
+	// Time in milliseconds from the input to the submission of the view family that shows it
+	//
+	std::atomic<float> InputToSubmitMs{ 0.0f };
+
+	//
+	// Time in seconds of the input evaluated by the camera but not yet handed to a view family, negative if none.
+	// 
+	// Note:
+	//	Only accessed from the game thread
+	//
+	double PendingSubmitInputTime{ -1.0 };
+
+	//
+	// Time in seconds of the input of the view family being rendered, negative if none.
+	// 
+	// Note:
+	//	Only accessed from the rendering thread
+	//
+	double RenderInputTime{ -1.0 };
+
+};
 
 
 /**
@@ -38,6 +79,7 @@ protected:
 
 protected:
 	virtual void OnRegister() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
@@ -64,12 +106,30 @@ protected:
 	UPROPERTY(Transient)
 	TSubclassOf<UViewMode> DefaultViewMode{ nullptr };
 
+	//
+	// Cache of the ViewMode that won the override arbitration.
+	// Updated only when an override request is added or removed.
+	//
 	UPROPERTY(Transient)
 	TSubclassOf<UViewMode> OverrideViewMode{ nullptr };
 
+	UPROPERTY(Transient)
+	FViewModeOverrideContainer ViewModeOverrides;
+
+	//
+	// Handle of the request made through SetViewModeOverride
+	//
+	UPROPERTY(Transient)
+	FViewModeOverrideHandle LegacyOverrideHandle;
+
 protected:
 	TSubclassOf<UViewMode> DetermineViewMode() const;
 
+	/**
+	 * Update the cached override ViewMode from the highest priority request
+	 */
+	void RefreshViewModeOverride();
+
 public:
 	/**
 	 * Set default ViewMode and initialize
@@ -77,8 +137,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "View")
 	void InitializeViewMode(TSubclassOf<UViewMode> InViewModeClass);
 
+	/**
+	 * Request a ViewMode override with the specified tag and priority.
+	 * The request with the highest priority is applied, and the most recent one wins ties.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "View")
+	FViewModeOverrideHandle AddViewModeOverride(TSubclassOf<UViewMode> InViewModeClass, FGameplayTag OverrideTag, int32 Priority = 0);
+
+	/**
+	 * Cancel the ViewMode override request of the specified handle
+	 */
+	UFUNCTION(BlueprintCallable, Category = "View")
+	bool RemoveViewModeOverride(UPARAM(ref) FViewModeOverrideHandle& Handle);
+
+	/**
+	 * Cancel all ViewMode override requests that match the specified tag
+	 */
+	UFUNCTION(BlueprintCallable, Category = "View")
+	int32 RemoveViewModeOverridesByTag(FGameplayTag OverrideTag);
+
+	/**
+	 * Returns the tag of the currently applied ViewMode override request
+	 */
+	UFUNCTION(BlueprintPure, Category = "View")
+	FGameplayTag GetActiveViewModeOverrideTag() const { return ViewModeOverrides.GetWinningTag(); }
+
 	/**
 	 * Override ViewMode
+	 * 
+	 * Note:
+	 *	This replaces the previous request made by this function and is arbitrated with priority 0.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "View")
 	void SetViewModeOverride(TSubclassOf<UViewMode> InViewModeClass);
@@ -89,11 +177,39 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "View")
 	void ClearViewModeOverride();
 
+	/**
+	 * Flag the ViewMode as likely to be pushed next (e.g. ADS while a weapon is equipped) to evaluate it in the background
+	 */
+	UFUNCTION(BlueprintCallable, Category = "View")
+	void AddWarmViewMode(TSubclassOf<UViewMode> InViewModeClass);
+
+	UFUNCTION(BlueprintCallable, Category = "View")
+	void RemoveWarmViewMode(TSubclassOf<UViewMode> InViewModeClass);
+
 
 protected:
+	//
+	// If true, the result of the stack evaluation is reused when the camera view is requested multiple times in the same frame.
+	// (e.g. several local players or spectators viewing this Pawn)
+	// Per-viewer camera modifiers are still applied by each PlayerCameraManager on top of the shared result.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View")
+	bool bShareEvaluationInFrame{ true };
+
+	//
+	// ViewModes likely to be pushed next, evaluated in the background so that the first frames after the push are cheap.
+	// The rate is set by "gvext.Stack.WarmUpRate".
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "View")
+	TArray<TSubclassOf<UViewMode>> WarmViewModes;
+
 	FRotator PreviousControlRotation;
 	FRotator ControlRotationDelta;
 
+	uint64 CachedEvaluationFrame{ MAX_uint64 };
+	TSubclassOf<UViewMode> CachedEvaluationViewMode{ nullptr };
+	FViewModeInfo CachedEvaluationInfo;
+
 protected:
 	virtual void GetCameraView(float DeltaTime, FMinimalViewInfo& DesiredView) override;
 
@@ -102,6 +218,301 @@ protected:
 	 */
 	virtual void ComputeCameraView(float DeltaTime, FMinimalViewInfo& DesiredView);
 
+	/**
+	 * Write the evaluated ViewMode information into the viewpoint information for Camera
+	 */
+	void ApplyViewModeInfo(const FViewModeInfo& InViewModeInfo, FMinimalViewInfo& DesiredView) const;
+
+
+protected:
+	//
+	// If true, the cost of the camera evaluation is measured and the quality is lowered while it exceeds the budget.
+	// The global budget shared by all viewers is set by "gvext.Budget.GlobalMs" and compared against the total of the world in the previous frame.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Budget")
+	bool bEnableEvaluationBudget{ false };
+
+	//
+	// Budget in milliseconds for the camera evaluation of this viewer
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Budget", meta = (EditCondition = "bEnableEvaluationBudget", ClampMin = "0.0", Units = "ms"))
+	float EvaluationBudgetMs{ 0.2f };
+
+	//
+	// Number of consecutive frames over budget before the quality is lowered by one level
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Budget", meta = (EditCondition = "bEnableEvaluationBudget", ClampMin = "1"))
+	int32 BudgetDowngradeFrames{ 10 };
+
+	//
+	// Number of consecutive frames under the recover threshold before the quality is raised by one level
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Budget", meta = (EditCondition = "bEnableEvaluationBudget", ClampMin = "1"))
+	int32 BudgetRecoverFrames{ 120 };
+
+	//
+	// Ratio of the budget under which the cost must stay to raise the quality
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Budget", meta = (EditCondition = "bEnableEvaluationBudget", ClampMin = "0.0", ClampMax = "1.0"))
+	float BudgetRecoverRatio{ 0.5f };
+
+	UPROPERTY(Transient)
+	EViewQualityLevel ViewQualityLevel{ EViewQualityLevel::Full };
+
+	float LastEvaluationMs{ 0.0f };
+	float SmoothedEvaluationMs{ 0.0f };
+	int32 OverBudgetFrames{ 0 };
+	int32 UnderBudgetFrames{ 0 };
+
+protected:
+	/**
+	 * Update the quality level from the measured cost of the camera evaluation
+	 */
+	void UpdateViewQualityLevel(float EvaluationMs);
+
+public:
+	/**
+	 * Returns the quality level that the ViewModes should use
+	 */
+	UFUNCTION(BlueprintPure, Category = "Budget")
+	EViewQualityLevel GetViewQualityLevel() const { return ViewQualityLevel; }
+
+	/**
+	 * Returns the cost of the last camera evaluation in milliseconds
+	 */
+	UFUNCTION(BlueprintPure, Category = "Budget")
+	float GetLastEvaluationTimeMs() const { return LastEvaluationMs; }
+
+
+protected:
+	//
+	// If true, the camera view of the locally controlled Pawn is sent to the server and replicated to the other clients.
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+	bool bReplicateViewState{ false };
+
+	//
+	// ViewModes that can be identified in the replicated view state
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (EditCondition = "bReplicateViewState"))
+	TArray<TSubclassOf<UViewMode>> ReplicatedViewModes;
+
+	//
+	// Minimum interval between updates of the view state
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (EditCondition = "bReplicateViewState", ClampMin = "0.0", Units = "s"))
+	float ViewStateMinSendInterval{ 0.05f };
+
+	//
+	// Maximum interval between updates of the view state, even if it has not changed
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (EditCondition = "bReplicateViewState", ClampMin = "0.0", Units = "s"))
+	float ViewStateMaxSendInterval{ 1.0f };
+
+	//
+	// Change in location that sends an update before the maximum interval
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (EditCondition = "bReplicateViewState", ClampMin = "0.0", Units = "cm"))
+	float ViewStateLocationThreshold{ 5.0f };
+
+	//
+	// Change in rotation that sends an update before the maximum interval
+	//
+	UPROPERTY(EditDefaultsOnly, Category = "Replication", meta = (EditCondition = "bReplicateViewState", ClampMin = "0.0", Units = "deg"))
+	float ViewStateRotationThreshold{ 1.0f };
+
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_ReplicatedViewState)
+	FReplicatedViewState ReplicatedViewState;
+
+	FReplicatedViewState LastSentViewState;
+	double LastViewStateSendTime{ 0.0 };
+
+	FReplicatedViewState InterpolationStartViewState;
+	double LastViewStateReceiveTime{ 0.0 };
+	float ViewStateInterpolationTime{ 0.0f };
+
+protected:
+	/**
+	 * Send the view state to the server if it has changed enough or the maximum interval has elapsed
+	 */
+	void UpdateReplicatedViewState(const FViewModeInfo& InViewModeInfo);
+
+	/**
+	 * Start interpolating from the current interpolated state to the newly received one
+	 */
+	void ReceiveReplicatedViewState(const FReplicatedViewState& NewViewState);
+
+	FReplicatedViewState GetInterpolatedViewState() const;
+
+	UFUNCTION(Server, Unreliable)
+	void ServerUpdateViewState(const FReplicatedViewState& NewViewState);
+
+	UFUNCTION()
+	void OnRep_ReplicatedViewState(const FReplicatedViewState& OldViewState);
+
+public:
+	/**
+	 * Returns the interpolated camera view replicated from the player viewing with this component.
+	 * Available on the server and the other clients when bReplicateViewState is enabled.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Replication")
+	bool GetReplicatedView(FVector& OutLocation, FRotator& OutRotation, float& OutFieldOfView) const;
+
+	/**
+	 * Returns the ViewMode replicated from the player viewing with this component
+	 */
+	UFUNCTION(BlueprintPure, Category = "Replication")
+	TSubclassOf<UViewMode> GetReplicatedViewMode() const;
+
+
+protected:
+	//
+	// If true, the time from the input notified by NotifyControlInput to the camera evaluation and to the submission of the view is measured.
+	// Results are available as "stat GVExt", in CSV profiles (category GVExt) and from Blueprint.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Latency")
+	bool bMeasureInputLatency{ false };
+
+	//
+	// Time in seconds (FPlatformTime::Seconds) of the oldest input not yet reflected in the camera, negative if none
+	//
+	double PendingInputTime{ -1.0 };
+
+	float InputToEvaluateMs{ 0.0f };
+
+	TSharedRef<FViewerInputLatencyState, ESPMode::ThreadSafe> InputLatencyState{ MakeShared<FViewerInputLatencyState, ESPMode::ThreadSafe>() };
+
+	//
+	// Scene view extension that samples the latency when the view family of this world is submitted
+	//
+	TSharedPtr<FViewerInputLatencyViewExtension, ESPMode::ThreadSafe> InputLatencyViewExtension;
+
+protected:
+	/**
+	 * Record the latency of the pending input for this camera evaluation and hand it to the next view family submission
+	 */
+	void MeasureInputLatency();
+
+public:
+	/**
+	 * Notify the time of the input event that changed the control rotation.
+	 * Only the oldest input until the next camera evaluation is measured.
+	 * 
+	 * Tips:
+	 *	If InputTimeSeconds is negative, the current time is used.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Latency")
+	void NotifyControlInput(double InputTimeSeconds = -1.0);
+
+	/**
+	 * Returns the time in milliseconds from the last measured input to the camera evaluation
+	 */
+	UFUNCTION(BlueprintPure, Category = "Latency")
+	float GetInputToEvaluateLatencyMs() const { return InputToEvaluateMs; }
+
+	/**
+	 * Returns the time in milliseconds from the last measured input to the submission of the view family that shows it
+	 */
+	UFUNCTION(BlueprintPure, Category = "Latency")
+	float GetInputToSubmitLatencyMs() const { return InputLatencyState->InputToSubmitMs.load(std::memory_order_relaxed); }
+
+
+protected:
+	//
+	// If true, the cost and the state of each camera evaluation are streamed to the Saved/Telemetry directory.
+	// Can be enabled for all viewers with "gvext.Telemetry.Enable" and summarized with -run=ViewTelemetrySummarize.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry")
+	bool bRecordTelemetry{ false };
+
+	TSharedPtr<FViewTelemetryWriter> TelemetryWriter;
+
+	uint8 LastTelemetryViewModeIndex{ MAX_uint8 };
+
+protected:
+	/**
+	 * Record the telemetry of this camera evaluation, opening the stream on first use
+	 */
+	void RecordTelemetry(TSubclassOf<UViewMode> ViewModeClass);
+
+	/**
+	 * Flush the recorded telemetry and close the stream
+	 */
+	void CloseTelemetry();
+
+
+protected:
+	UPROPERTY(Transient)
+	FViewFeelerTraceResult FeelerTraceResult;
+
+	UPROPERTY(Transient)
+	TArray<FViewTraceRequest> ViewTraceRequests;
+
+	UPROPERTY(Transient)
+	TArray<FViewTraceChannelResult> ViewTraceResults;
+
+protected:
+	/**
+	 * Trace once per channel along the evaluated view for all requests
+	 */
+	void UpdateViewTraces(const FViewModeInfo& InViewModeInfo);
+
+public:
+	/**
+	 * Called by the active ViewMode to share the result of its camera penetration feelers
+	 */
+	void PublishFeelerTraceResult(const FViewFeelerTraceResult& InResult);
+
+	/**
+	 * Returns the last result of the camera penetration feelers and the number of frames since it was published
+	 */
+	UFUNCTION(BlueprintPure, Category = "Trace")
+	bool GetFeelerTraceResult(FViewFeelerTraceResult& OutResult, int32& OutFrameAge) const;
+
+	/**
+	 * Request a trace along the view direction of the camera that is done once per frame after the camera evaluation.
+	 * Requests of the same channel share a single trace.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trace")
+	FViewTraceRequestHandle AddViewTraceRequest(ECollisionChannel TraceChannel, float Distance);
+
+	/**
+	 * Cancel the view trace request of the specified handle
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trace")
+	bool RemoveViewTraceRequest(UPARAM(ref) FViewTraceRequestHandle& Handle);
+
+	/**
+	 * Returns the result of the view trace of this frame for the request, limited to the requested distance
+	 * 
+	 * Tips:
+	 *	OutHit is reset when there is no blocking hit within the requested distance.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Trace")
+	bool GetViewTraceResult(FViewTraceRequestHandle Handle, FHitResult& OutHit) const;
+
+
+protected:
+	//
+	// If true, the camera pose of each frame is published to a buffer that can be read from any thread
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View")
+	bool bPublishPoseSnapshot{ true };
+
+	TSharedRef<FViewPoseSnapshotBuffer, ESPMode::ThreadSafe> PoseSnapshots{ MakeShared<FViewPoseSnapshotBuffer, ESPMode::ThreadSafe>() };
+
+protected:
+	void PublishPoseSnapshot(float DeltaTime, TSubclassOf<UViewMode> ViewModeClass);
+
+public:
+	/**
+	 * Returns the buffer of the published camera poses.
+	 * 
+	 * Tips:
+	 *	Worker threads should keep the returned reference instead of accessing this component.
+	 */
+	TSharedRef<FViewPoseSnapshotBuffer, ESPMode::ThreadSafe> GetPoseSnapshotBuffer() const { return PoseSnapshots; }
+
 
 public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Components")
@@ -0,0 +1,121 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "GVExtScalability.h"
+
+#include "GVExtLogs.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ConfigCacheIni.h"
+
+
+static int32 GCameraQualityMaxFeelers{ INDEX_NONE };
+static FAutoConsoleVariableRef CVarCameraQualityMaxFeelers(
+	TEXT("gvext.Collision.MaxFeelers"),
+	GCameraQualityMaxFeelers,
+	TEXT("Maximum number of penetration avoidance feelers traced by a third person ViewMode. -1 means no limit."),
+	ECVF_Scalability);
+
+static bool GCameraQualityPredictiveAvoidance{ true };
+static FAutoConsoleVariableRef CVarCameraQualityPredictiveAvoidance(
+	TEXT("gvext.Collision.PredictiveAvoidance"),
+	GCameraQualityPredictiveAvoidance,
+	TEXT("If false, the predictive avoidance feelers are disabled regardless of the ViewMode settings."),
+	ECVF_Scalability);
+
+static float GCameraQualityTraceIntervalScale{ 1.0f };
+static FAutoConsoleVariableRef CVarCameraQualityTraceIntervalScale(
+	TEXT("gvext.Collision.TraceIntervalScale"),
+	GCameraQualityTraceIntervalScale,
+	TEXT("Scale applied to the trace interval of the penetration avoidance feelers."),
+	ECVF_Scalability);
+
+static int32 GCameraQualityPenetrationUpdateInterval{ 1 };
+static FAutoConsoleVariableRef CVarCameraQualityPenetrationUpdateInterval(
+	TEXT("gvext.Collision.PenetrationUpdateInterval"),
+	GCameraQualityPenetrationUpdateInterval,
+	TEXT("Number of frames between penetration updates. The last result is reused in between."),
+	ECVF_Scalability);
+
+static bool GCameraAsyncSweeps{ false };
+static FAutoConsoleVariableRef CVarCameraAsyncSweeps(
+	TEXT("gvext.Collision.AsyncSweeps"),
+	GCameraAsyncSweeps,
+	TEXT("If true, the predictive avoidance feelers due in the next frame are submitted as async sweeps at the end of the penetration update and their results are used in the following frame."),
+	ECVF_Scalability);
+
+
+/**
+ * Built-in values of each camera quality level, used when Scalability.ini does not override them
+ */
+struct FCameraQualityLevelSettings
+{
+	int32 MaxFeelers;
+	bool bPredictiveAvoidance;
+	float TraceIntervalScale;
+	int32 PenetrationUpdateInterval;
+	bool bAsyncSweeps;
+};
+
+static const FCameraQualityLevelSettings GCameraQualityLevels[]
+{
+	{ 1,			false,	2.0f,	2,	true },		// Low
+	{ 3,			true,	2.0f,	1,	true },		// Medium
+	{ INDEX_NONE,	true,	1.5f,	1,	false },	// High
+	{ INDEX_NONE,	true,	1.0f,	1,	false },	// Epic
+};
+
+static void OnCameraQualityChanged(IConsoleVariable* Variable)
+{
+	const auto Level{ FMath::Clamp(Variable->GetInt(), 0, static_cast<int32>(UE_ARRAY_COUNT(GCameraQualityLevels)) - 1) };
+	const auto& Settings{ GCameraQualityLevels[Level] };
+
+	CVarCameraQualityMaxFeelers->Set(Settings.MaxFeelers, ECVF_SetByScalability);
+	CVarCameraQualityPredictiveAvoidance->Set(Settings.bPredictiveAvoidance, ECVF_SetByScalability);
+	CVarCameraQualityTraceIntervalScale->Set(Settings.TraceIntervalScale, ECVF_SetByScalability);
+	CVarCameraQualityPenetrationUpdateInterval->Set(Settings.PenetrationUpdateInterval, ECVF_SetByScalability);
+	CVarCameraAsyncSweeps->Set(Settings.bAsyncSweeps, ECVF_SetByScalability);
+
+	// Let the project override the built-in values from Scalability.ini
+
+	ApplyCVarSettingsFromIni(*FString::Printf(TEXT("CameraQuality@%d"), Level), *GScalabilityIni, ECVF_SetByScalability);
+
+	UE_LOG(LogGVE, Log, TEXT("Camera quality set to %d"), Level);
+}
+
+static int32 GCameraQuality{ 3 };
+static FAutoConsoleVariableRef CVarCameraQuality(
+	TEXT("sg.CameraQuality"),
+	GCameraQuality,
+	TEXT("Scalability quality level of the camera evaluation.\n")
+	TEXT(" 0: Low\n")
+	TEXT(" 1: Medium\n")
+	TEXT(" 2: High\n")
+	TEXT(" 3: Epic (default)"),
+	FConsoleVariableDelegate::CreateStatic(&OnCameraQualityChanged),
+	ECVF_ScalabilityGroup);
+
+
+int32 GVExtScalability::GetMaxFeelers()
+{
+	return GCameraQualityMaxFeelers;
+}
+
+bool GVExtScalability::IsPredictiveAvoidanceAllowed()
+{
+	return GCameraQualityPredictiveAvoidance;
+}
+
+float GVExtScalability::GetTraceIntervalScale()
+{
+	return FMath::Max(GCameraQualityTraceIntervalScale, 0.0f);
+}
+
+int32 GVExtScalability::GetPenetrationUpdateInterval()
+{
+	return FMath::Max(GCameraQualityPenetrationUpdateInterval, 1);
+}
+
+bool GVExtScalability::IsAsyncSweepEnabled()
+{
+	return GCameraAsyncSweeps;
+}
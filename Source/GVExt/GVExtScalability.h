@@ -0,0 +1,42 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Scalability settings of the camera evaluation
+ *
+ * Note:
+ *	All values can be set per platform from device profiles (e.g. +CVars=sg.CameraQuality=1)
+ *	or per scalability level from the [CameraQuality@N] sections of Scalability.ini.
+ *	Changing "sg.CameraQuality" applies the built-in values of the level first, then the ini section of the level.
+ */
+namespace GVExtScalability
+{
+	/**
+	 * Returns the maximum number of penetration avoidance feelers to trace. INDEX_NONE means no limit.
+	 */
+	GVEXT_API int32 GetMaxFeelers();
+
+	/**
+	 * Returns whether the predictive avoidance feelers are allowed
+	 */
+	GVEXT_API bool IsPredictiveAvoidanceAllowed();
+
+	/**
+	 * Returns the scale applied to the trace interval of the feelers
+	 */
+	GVEXT_API float GetTraceIntervalScale();
+
+	/**
+	 * Returns the number of frames between penetration updates
+	 */
+	GVEXT_API int32 GetPenetrationUpdateInterval();
+
+	/**
+	 * Returns whether the predictive avoidance feelers may be traced asynchronously with one frame of latency
+	 */
+	GVEXT_API bool IsAsyncSweepEnabled();
+}
@@ -0,0 +1,30 @@
+﻿// Copyright (C) 2024 owoDra
+
+using UnrealBuildTool;
+
+public class GVExtTests : ModuleRules
+{
+	public GVExtTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicIncludePaths.AddRange(
+           new string[]
+           {
+                ModuleDirectory,
+                ModuleDirectory + "/GVExtTests",
+           }
+       );
+
+
+        PublicDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "Core",
+                "CoreUObject",
+                "Engine",
+                "GVExt",
+            }
+        );
+    }
+}
@@ -0,0 +1,14 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "GVExtTests.h"
+
+IMPLEMENT_MODULE(FGVExtTestsModule, GVExtTests)
+
+
+void FGVExtTestsModule::StartupModule()
+{
+}
+
+void FGVExtTestsModule::ShutdownModule()
+{
+}
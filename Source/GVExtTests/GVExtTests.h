@@ -0,0 +1,16 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Modules/ModuleManager.h"
+
+/**
+ *  Modules for the automation tests and benchmarks of the Game View Extension plugin
+ */
+class FGVExtTestsModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+};
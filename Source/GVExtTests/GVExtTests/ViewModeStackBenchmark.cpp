@@ -0,0 +1,54 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeStackTestAccess.h"
+#include "ViewModeTestTypes.h"
+
+#include "GVExtLogs.h"
+
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Measure the cost of pushing a ViewMode that is already in a Stack of the specified number of layers.
+ * Usage: gvext.Stack.BenchmarkPush [Iterations]
+ * Can be run headless with -ExecCmds="gvext.Stack.BenchmarkPush".
+ */
+static FAutoConsoleCommand CmdStackBenchmarkPush(
+	TEXT("gvext.Stack.BenchmarkPush"),
+	TEXT("Measure the cost of pushing a ViewMode again for 1 to 16 layers. Usage: gvext.Stack.BenchmarkPush [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda(
+		[](const TArray<FString>& Args)
+		{
+			const auto Iterations{ Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000 };
+
+			for (auto NumLayers{ 1 }; NumLayers <= 16; NumLayers *= 2)
+			{
+				auto* Stack{ NewObject<UViewModeStack>(GetTransientPackage()) };
+
+				// The layers are added directly since the instances are looked up by class when pushed by class
+
+				for (auto LayerIndex{ 0 }; LayerIndex < NumLayers; ++LayerIndex)
+				{
+					FViewModeStackTestAccess::AddViewMode(*Stack, NewObject<UViewMode>(GetTransientPackage(), UViewModeTest_A::StaticClass()));
+				}
+
+				// The deepest layer is the worst case of the search in the Stack
+
+				const auto StartCycles{ FPlatformTime::Cycles64() };
+
+				for (auto Iteration{ 0 }; Iteration < Iterations; ++Iteration)
+				{
+					FViewModeStackTestAccess::ActivateViewModeAt(*Stack, NumLayers - 1);
+				}
+
+				const auto ElapsedNs{ FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1.0e9 };
+
+				UE_LOG(LogGVE, Display, TEXT("BenchmarkPush: %2d layers: %.2f ns/push (depth %d)"), NumLayers, ElapsedNs / Iterations, Stack->GetStackDepth());
+
+				Stack->ReleaseViewModes();
+			}
+		}));
+
+#endif
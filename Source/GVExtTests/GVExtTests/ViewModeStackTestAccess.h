@@ -0,0 +1,31 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewModeStack.h"
+
+
+/**
+ * Access to the internals of UViewModeStack for the automation tests and benchmarks
+ */
+struct FViewModeStackTestAccess
+{
+public:
+	/**
+	 * Add the instance to the Stack without looking it up by class, so that a Stack can hold several instances of the same class
+	 */
+	static void AddViewMode(UViewModeStack& Stack, UViewMode* ViewMode)
+	{
+		Stack.ViewModeInstances.Add(ViewMode);
+		Stack.ActivateViewMode(ViewMode);
+	}
+
+	/**
+	 * Push again the instance at the index of the Stack
+	 */
+	static void ActivateViewModeAt(UViewModeStack& Stack, int32 StackIndex)
+	{
+		Stack.ActivateViewMode(Stack.ViewModeStack[StackIndex]);
+	}
+
+};
@@ -0,0 +1,174 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeTestTypes.h"
+
+#include "Mode/ViewModeStack.h"
+
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ViewModeStackTests
+{
+	constexpr auto NumSeeds{ 16 };
+	constexpr auto NumSteps{ 256 };
+	constexpr auto PoseTolerance{ 0.01f };
+
+	/**
+	 * Returns the first broken invariant of the Stack, or an empty string
+	 */
+	FString CheckInvariants(const UViewModeStack& Stack)
+	{
+		const auto ViewModes{ Stack.GetStackViewModes() };
+
+		if (ViewModes.Num() > Stack.GetNumViewModeInstances())
+		{
+			return FString::Printf(TEXT("Stack depth %d exceeds %d instances"), ViewModes.Num(), Stack.GetNumViewModeInstances());
+		}
+
+		for (auto StackIndex{ 0 }; StackIndex < ViewModes.Num(); ++StackIndex)
+		{
+			const auto Weight{ ViewModes[StackIndex]->GetBlendWeight() };
+
+			if ((Weight < 0.0f) || (Weight > 1.0f))
+			{
+				return FString::Printf(TEXT("Weight %f of layer %d is out of [0, 1]"), Weight, StackIndex);
+			}
+		}
+
+		if (!ViewModes.IsEmpty() && !Stack.HasFrozenBase() && (ViewModes.Last()->GetBlendWeight() != 1.0f))
+		{
+			return FString::Printf(TEXT("Base layer weight %f is not 1 without a frozen base"), ViewModes.Last()->GetBlendWeight());
+		}
+
+		return FString();
+	}
+
+	bool IsSamePose(const FViewModeInfo& A, const FViewModeInfo& B)
+	{
+		return A.Location.Equals(B.Location, PoseTolerance)
+			&& A.Rotation.Equals(B.Rotation, PoseTolerance)
+			&& FMath::IsNearlyEqual(A.FieldOfView, B.FieldOfView, PoseTolerance);
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FViewModeStackRandomizedTest, "GVExt.ViewModeStack.RandomizedPush", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FViewModeStackRandomizedTest::RunTest(const FString& Parameters)
+{
+	using namespace ViewModeStackTests;
+
+	const TSubclassOf<UViewMode> ViewModeClasses[]
+	{
+		UViewModeTest_A::StaticClass(),
+		UViewModeTest_B::StaticClass(),
+		UViewModeTest_C::StaticClass(),
+		UViewModeTest_D::StaticClass(),
+	};
+
+	for (auto Seed{ 0 }; Seed < NumSeeds; ++Seed)
+	{
+		auto RandomStream{ FRandomStream(Seed) };
+
+		auto* Stack{ NewObject<UViewModeStack>(GetTransientPackage()) };
+
+		auto LastView{ FViewModeInfo() };
+		auto bHasLastView{ false };
+
+		for (auto Step{ 0 }; Step < NumSteps; ++Step)
+		{
+			// Push a random ViewMode, which is often already in the Stack
+
+			if (RandomStream.FRand() < 0.5f)
+			{
+				const auto& ViewModeClass{ ViewModeClasses[RandomStream.RandRange(0, UE_ARRAY_COUNT(ViewModeClasses) - 1)] };
+
+				Stack->PushViewMode(ViewModeClass);
+
+				const auto PushError{ CheckInvariants(*Stack) };
+
+				if (!PushError.IsEmpty())
+				{
+					AddError(FString::Printf(TEXT("Seed %d, step %d, after pushing %s: %s"), Seed, Step, *ViewModeClass->GetName(), *PushError));
+					return false;
+				}
+
+				// The pose must not jump when no time has passed since the last evaluation
+
+				if (bHasLastView)
+				{
+					auto View{ FViewModeInfo() };
+					Stack->EvaluateStack(0.0f, View);
+
+					if (!IsSamePose(View, LastView))
+					{
+						AddError(FString::Printf(TEXT("Seed %d, step %d: pose jumped after pushing %s (Location %s -> %s, FOV %f -> %f)"),
+							Seed, Step, *ViewModeClass->GetName(), *LastView.Location.ToString(), *View.Location.ToString(), LastView.FieldOfView, View.FieldOfView));
+						return false;
+					}
+				}
+			}
+
+			Stack->EvaluateStack(RandomStream.FRandRange(0.0f, 0.1f), LastView);
+			bHasLastView = (Stack->GetStackDepth() > 0);
+
+			const auto EvaluateError{ CheckInvariants(*Stack) };
+
+			if (!EvaluateError.IsEmpty())
+			{
+				AddError(FString::Printf(TEXT("Seed %d, step %d, after evaluation: %s"), Seed, Step, *EvaluateError));
+				return false;
+			}
+		}
+
+		Stack->ReleaseViewModes();
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FViewModeStackRepushKeepsPoseTest, "GVExt.ViewModeStack.RepushKeepsPose", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FViewModeStackRepushKeepsPoseTest::RunTest(const FString& Parameters)
+{
+	using namespace ViewModeStackTests;
+
+	// Stack of [C 0.5, B 0.5, A 1.0], whose pose is 0.5 C + 0.25 B + 0.25 A
+
+	auto* Stack{ NewObject<UViewModeStack>(GetTransientPackage()) };
+	auto View{ FViewModeInfo() };
+
+	Stack->PushViewMode(UViewModeTest_A::StaticClass());
+	Stack->EvaluateStack(0.0f, View);
+
+	Stack->PushViewMode(UViewModeTest_B::StaticClass());
+	Stack->PushViewMode(UViewModeTest_C::StaticClass());
+
+	const auto ViewModes{ Stack->GetStackViewModes() };
+	ViewModes[0]->SetBlendWeight(0.5f);
+	ViewModes[1]->SetBlendWeight(0.5f);
+
+	auto PoseBefore{ FViewModeInfo() };
+	Stack->EvaluateStack(0.0f, PoseBefore);
+
+	// Pushing the base again puts it on top with its 0.25 contribution.
+	// C and B must keep 0.5 and 0.25 of the pose instead of being renormalized to 0.375 each.
+
+	Stack->PushViewMode(UViewModeTest_A::StaticClass());
+
+	auto PoseAfter{ FViewModeInfo() };
+	Stack->EvaluateStack(0.0f, PoseAfter);
+
+	TestEqual(TEXT("Stack depth after pushing the base again"), Stack->GetStackDepth(), 3);
+	TestTrue(FString::Printf(TEXT("Pose kept after pushing the base again (Location %s -> %s, FOV %f -> %f)"),
+		*PoseBefore.Location.ToString(), *PoseAfter.Location.ToString(), PoseBefore.FieldOfView, PoseAfter.FieldOfView), IsSamePose(PoseBefore, PoseAfter));
+
+	Stack->ReleaseViewModes();
+
+	return true;
+}
+
+#endif
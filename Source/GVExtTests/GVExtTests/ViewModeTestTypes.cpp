@@ -0,0 +1,60 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ViewModeTestTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ViewModeTestTypes)
+
+
+UViewModeTest::UViewModeTest(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+void UViewModeTest::UpdateView(float DeltaTime)
+{
+	View.Location = TestLocation;
+	View.Rotation = TestRotation;
+	View.ControlRotation = TestRotation;
+	View.FieldOfView = FieldOfView;
+}
+
+
+UViewModeTest_A::UViewModeTest_A(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	TestLocation = FVector(100.0f, 0.0f, 0.0f);
+	TestRotation = FRotator(0.0f, 10.0f, 0.0f);
+	FieldOfView = 90.0f;
+	BlendTime = 0.5f;
+	BlendFunction = EViewModeBlendFunction::Linear;
+}
+
+UViewModeTest_B::UViewModeTest_B(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	TestLocation = FVector(0.0f, 200.0f, 50.0f);
+	TestRotation = FRotator(-20.0f, 40.0f, 0.0f);
+	FieldOfView = 70.0f;
+	BlendTime = 0.2f;
+	BlendFunction = EViewModeBlendFunction::EaseOut;
+}
+
+UViewModeTest_C::UViewModeTest_C(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	TestLocation = FVector(-150.0f, -50.0f, 300.0f);
+	TestRotation = FRotator(30.0f, -30.0f, 0.0f);
+	FieldOfView = 110.0f;
+	BlendTime = 1.0f;
+	BlendFunction = EViewModeBlendFunction::EaseIn;
+}
+
+UViewModeTest_D::UViewModeTest_D(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	TestLocation = FVector(50.0f, -250.0f, -100.0f);
+	TestRotation = FRotator(10.0f, 60.0f, 0.0f);
+	FieldOfView = 60.0f;
+	BlendTime = 0.3f;
+	BlendFunction = EViewModeBlendFunction::EaseInOut;
+}
@@ -0,0 +1,66 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Mode/ViewMode.h"
+
+#include "ViewModeTestTypes.generated.h"
+
+
+/**
+ * ViewMode with a fixed view used by the automation tests and benchmarks of the ViewModeStack
+ *
+ * Note:
+ *	Only built in the GVExtTests module, so these classes never ship with the game.
+ */
+UCLASS(Abstract, Transient, NotBlueprintable, HideDropdown)
+class UViewModeTest : public UViewMode
+{
+	GENERATED_BODY()
+public:
+	UViewModeTest(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	FVector TestLocation{ FVector::ZeroVector };
+	FRotator TestRotation{ FRotator::ZeroRotator };
+
+protected:
+	virtual void UpdateView(float DeltaTime) override;
+
+};
+
+
+UCLASS(Transient, NotBlueprintable, HideDropdown)
+class UViewModeTest_A : public UViewModeTest
+{
+	GENERATED_BODY()
+public:
+	UViewModeTest_A(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
+
+
+UCLASS(Transient, NotBlueprintable, HideDropdown)
+class UViewModeTest_B : public UViewModeTest
+{
+	GENERATED_BODY()
+public:
+	UViewModeTest_B(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
+
+
+UCLASS(Transient, NotBlueprintable, HideDropdown)
+class UViewModeTest_C : public UViewModeTest
+{
+	GENERATED_BODY()
+public:
+	UViewModeTest_C(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
+
+
+UCLASS(Transient, NotBlueprintable, HideDropdown)
+class UViewModeTest_D : public UViewModeTest
+{
+	GENERATED_BODY()
+public:
+	UViewModeTest_D(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};